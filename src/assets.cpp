@@ -2,989 +2,769 @@
 /* (c) copyright 2024 Lawrence D. Kern /////////////////////////////////////// */
 /* /////////////////////////////////////////////////////////////////////////// */
 
-enum mesh_id
+#define ASSET_PACK_PATH "./data/assets.pack"
+
+static bool pack_range_valid(u64 offset, u64 size, u64 limit)
 {
-   MESHID_cube,
-   MESHID_falcon,
-};
-
-vec3 cube_vertices[] = {
-   {1.000000f, -1.000000f, 1.000000f},
-   {1.000000f, -1.000000f, -1.000000f},
-   {-1.000000f, -1.000000f, 1.000000f},
-   {-1.000000f, -1.000000f, -1.000000f},
-   {1.000000f, 1.000000f, 1.000000f},
-   {1.000000f, 1.000000f, -1.000000f},
-   {-1.000000f, 1.000000f, 1.000000f},
-   {-1.000000f, 1.000000f, -1.000000f},
-};
-
-vec2 cube_texcoords[] = {
-   {0.875000f, 0.500000f},
-   {0.625000f, 0.750000f},
-   {0.625000f, 0.500000f},
-   {0.375000f, 1.000000f},
-   {0.375000f, 0.750000f},
-   {0.625000f, 0.000000f},
-   {0.375000f, 0.250000f},
-   {0.375000f, 0.000000f},
-   {0.375000f, 0.500000f},
-   {0.125000f, 0.750000f},
-   {0.125000f, 0.500000f},
-   {0.625000f, 0.250000f},
-   {0.875000f, 0.750000f},
-   {0.625000f, 1.000000f},
-};
-
-vec3 cube_normals[] = {
-   {-0.000000f, -0.000000f, 1.000000f},
-   {-1.000000f, -0.000000f, -0.000000f},
-   {-0.000000f, 1.000000f, -0.000000f},
-   {-0.000000f, -0.000000f, -1.000000f},
-   {-0.000000f, -1.000000f, -0.000000f},
-   {1.000000f, -0.000000f, -0.000000f},
-};
-
-mesh_asset_face cube_faces[] = {
-   {{4, 2, 0}, {0, 1, 2}, {0, 0, 0}, 0x555555ff},
-   {{2, 7, 3}, {1, 3, 4}, {1, 1, 1}, 0x555555ff},
-   {{6, 5, 7}, {5, 6, 7}, {2, 2, 2}, 0x555555ff},
-   {{1, 7, 5}, {8, 9, 10}, {3, 3, 3}, 0x555555ff},
-   {{0, 3, 1}, {2, 4, 8}, {4, 4, 4}, 0x555555ff},
-   {{4, 1, 5}, {11, 8, 6}, {5, 5, 5}, 0x555555ff},
-   {{4, 6, 2}, {0, 12, 1}, {0, 0, 0}, 0x555555ff},
-   {{2, 6, 7}, {1, 13, 3}, {1, 1, 1}, 0x555555ff},
-   {{6, 4, 5}, {5, 11, 6}, {2, 2, 2}, 0x555555ff},
-   {{1, 3, 7}, {8, 4, 9}, {3, 3, 3}, 0x555555ff},
-   {{0, 2, 3}, {2, 1, 4}, {4, 4, 4}, 0x555555ff},
-   {{4, 0, 1}, {11, 2, 8}, {5, 5, 5}, 0x555555ff},
-};
-
-vec3 falcon_vertices[] = {
-   {-1.455794f, -0.954372f, -0.546874f},
-   {-1.348915f, -0.877117f, -0.078402f},
-   {1.902644f, -1.077451f, -0.768159f},
-   {1.579599f, -0.851699f, 0.549471f},
-   {-1.090769f, -1.381343f, -0.757131f},
-   {0.036337f, -1.364033f, -0.874754f},
-   {0.833370f, -1.204074f, -0.760708f},
-   {0.833370f, -0.824033f, 0.932813f},
-   {0.036337f, -0.822912f, 0.914045f},
-   {-0.986627f, -0.872181f, 0.298310f},
-   {1.970731f, -0.799372f, -0.810129f},
-   {-2.090647f, 0.000000f, -0.250740f},
-   {1.607432f, -0.648978f, 0.479383f},
-   {2.053672f, 0.000000f, 0.161490f},
-   {-1.560550f, -0.568716f, -0.598985f},
-   {-1.456365f, -0.568716f, -0.007780f},
-   {1.970731f, -0.799372f, 0.297741f},
-   {-1.623391f, -0.568716f, -0.313428f},
-   {0.833370f, -0.568716f, 0.654888f},
-   {-1.090769f, -1.482508f, -0.101689f},
-   {0.036337f, -0.568716f, 0.638486f},
-   {0.024872f, -1.265220f, 0.866079f},
-   {-0.986627f, -0.568716f, 0.362080f},
-   {0.833370f, -0.926063f, -0.992422f},
-   {0.833370f, -1.185198f, 0.915254f},
-   {0.036337f, -0.926063f, -0.974623f},
-   {-1.474425f, -1.007005f, -0.258558f},
-   {-0.986627f, -0.820101f, -0.963996f},
-   {1.902644f, -1.077451f, 0.402796f},
-   {2.053672f, 0.005163f, -0.810129f},
-   {1.684700f, 0.000000f, 0.466326f},
-   {-1.978157f, 0.000000f, -0.881193f},
-   {-1.878761f, 0.000000f, 0.291510f},
-   {0.833370f, 0.000000f, 0.801310f},
-   {0.036337f, 0.000000f, 1.127915f},
-   {-0.986627f, 0.000000f, 0.950564f},
-   {0.833370f, 0.000000f, -1.000000f},
-   {0.036337f, 0.000000f, -1.000000f},
-   {-0.986627f, 0.000000f, -1.000000f},
-   {1.984435f, -1.345331f, 0.254140f},
-   {1.984435f, -1.345331f, -0.623603f},
-   {1.170070f, -1.591982f, -0.740017f},
-   {-0.635799f, -1.776513f, -0.400186f},
-   {-0.216885f, -1.591982f, -0.740017f},
-   {1.218568f, -1.591982f, 0.359870f},
-   {-0.216885f, -1.591982f, 0.175643f},
-   {-0.521867f, -1.776513f, 0.016258f},
-   {1.653976f, -0.323235f, 0.466326f},
-   {-1.914092f, -0.326240f, -0.820788f},
-   {0.833370f, -0.326240f, 0.758535f},
-   {0.036337f, -0.326240f, 1.074531f},
-   {-0.986627f, -0.326240f, 0.900215f},
-   {-2.023432f, -0.326240f, -0.271863f},
-   {2.053672f, -0.326240f, 0.161490f},
-   {2.053672f, -0.321077f, -0.810129f},
-   {-1.811547f, -0.326240f, 0.229078f},
-   {0.833370f, -0.326240f, -0.995049f},
-   {0.036337f, -0.326240f, -0.995049f},
-   {-0.986627f, -0.326240f, -0.995049f},
-   {1.299366f, -1.162965f, -0.760708f},
-   {1.285663f, -0.819407f, 0.714904f},
-   {1.285663f, -0.926063f, -0.992422f},
-   {1.283726f, -0.558037f, 0.495081f},
-   {1.285663f, -1.133069f, 0.591476f},
-   {1.285663f, 0.000000f, 0.617918f},
-   {1.285663f, 0.000000f, -1.000000f},
-   {2.019327f, -1.591982f, -0.731136f},
-   {1.984435f, -1.591982f, 0.149760f},
-   {1.285663f, -0.326240f, 0.536003f},
-   {1.285663f, -0.326240f, -0.995049f},
-   {1.984435f, -1.739388f, 0.236545f},
-   {0.093701f, -1.739388f, 0.430668f},
-   {0.079998f, -1.739388f, -0.797997f},
-   {1.244578f, -1.739388f, -0.879141f},
-   {2.019327f, -1.739388f, -0.808977f},
-   {1.199368f, -1.739388f, 0.359870f},
-   {0.340341f, -1.842883f, -0.711612f},
-   {1.244578f, -1.872661f, -0.783768f},
-   {1.199368f, -1.923138f, 0.617080f},
-   {2.019327f, -1.882936f, -0.721376f},
-   {1.984435f, -1.923138f, 0.487410f},
-   {0.327323f, -1.856241f, 0.521667f},
-   {1.984435f, -1.739388f, 0.997328f},
-   {1.264076f, -1.739388f, 1.160087f},
-   {0.577108f, -1.739388f, 0.855427f},
-   {1.953612f, -1.855257f, 0.942283f},
-   {1.264076f, -1.873808f, 1.094314f},
-   {0.577108f, -1.878915f, 0.855427f},
-   {2.232210f, -1.739388f, 0.220954f},
-   {2.232210f, -1.739388f, -0.513682f},
-   {2.163696f, -1.880411f, 0.242824f},
-   {2.163696f, -1.879185f, -0.451301f},
-   {2.163696f, -1.876077f, 0.631919f},
-   {2.232210f, -1.739388f, 0.631919f},
-   {-1.455794f, 0.954372f, -0.546874f},
-   {-1.348915f, 0.877117f, -0.078402f},
-   {1.902644f, 1.077451f, -0.768159f},
-   {1.579599f, 0.851699f, 0.549471f},
-   {-1.090769f, 1.381343f, -0.757131f},
-   {0.036337f, 1.364033f, -0.874754f},
-   {0.833370f, 1.204074f, -0.760708f},
-   {0.833370f, 0.824033f, 0.932813f},
-   {0.036337f, 0.822912f, 0.914045f},
-   {-0.986627f, 0.872181f, 0.298310f},
-   {1.970731f, 0.799372f, -0.810129f},
-   {1.607432f, 0.648978f, 0.479383f},
-   {-1.560550f, 0.568716f, -0.598985f},
-   {-1.456365f, 0.568716f, -0.007780f},
-   {1.970731f, 0.799372f, 0.297741f},
-   {-1.623391f, 0.568716f, -0.313428f},
-   {0.833370f, 0.568716f, 0.654888f},
-   {-1.090769f, 1.482508f, -0.101689f},
-   {0.036337f, 0.568716f, 0.638486f},
-   {0.024872f, 1.265220f, 0.866079f},
-   {-0.986627f, 0.568716f, 0.362080f},
-   {0.833370f, 0.926063f, -0.992422f},
-   {0.833370f, 1.185198f, 0.915254f},
-   {0.036337f, 0.926063f, -0.974623f},
-   {-1.474425f, 1.007005f, -0.258558f},
-   {-0.986627f, 0.820101f, -0.963996f},
-   {1.902644f, 1.077451f, 0.402796f},
-   {2.053672f, -0.005163f, -0.810129f},
-   {1.984435f, 1.345331f, 0.254140f},
-   {1.984435f, 1.345331f, -0.623603f},
-   {1.170070f, 1.591982f, -0.740017f},
-   {-0.635799f, 1.776513f, -0.400186f},
-   {-0.216885f, 1.591982f, -0.740017f},
-   {1.218568f, 1.591982f, 0.359870f},
-   {-0.216885f, 1.591982f, 0.175643f},
-   {-0.521867f, 1.776513f, 0.016258f},
-   {1.653976f, 0.323235f, 0.466326f},
-   {-1.914092f, 0.326240f, -0.820788f},
-   {0.833370f, 0.326240f, 0.758535f},
-   {0.036337f, 0.326240f, 1.074531f},
-   {-0.986627f, 0.326240f, 0.900215f},
-   {-2.023432f, 0.326240f, -0.271863f},
-   {2.053672f, 0.326240f, 0.161490f},
-   {2.053672f, 0.321077f, -0.810129f},
-   {-1.811547f, 0.326240f, 0.229078f},
-   {0.833370f, 0.326240f, -0.995049f},
-   {0.036337f, 0.326240f, -0.995049f},
-   {-0.986627f, 0.326240f, -0.995049f},
-   {1.299366f, 1.162965f, -0.760708f},
-   {1.285663f, 0.819407f, 0.714904f},
-   {1.285663f, 0.926063f, -0.992422f},
-   {1.283726f, 0.558037f, 0.495081f},
-   {1.285663f, 1.133069f, 0.591476f},
-   {2.019327f, 1.591982f, -0.731136f},
-   {1.984435f, 1.591982f, 0.149760f},
-   {1.285663f, 0.326240f, 0.536003f},
-   {1.285663f, 0.326240f, -0.995049f},
-   {1.984435f, 1.739388f, 0.236545f},
-   {0.093701f, 1.739388f, 0.430668f},
-   {0.079998f, 1.739388f, -0.797997f},
-   {1.244578f, 1.739388f, -0.879141f},
-   {2.019327f, 1.739388f, -0.808977f},
-   {1.199368f, 1.739388f, 0.359870f},
-   {0.340341f, 1.842883f, -0.711612f},
-   {1.244578f, 1.872661f, -0.783768f},
-   {1.199368f, 1.923138f, 0.617080f},
-   {2.019327f, 1.882936f, -0.721376f},
-   {1.984435f, 1.923138f, 0.487410f},
-   {0.327323f, 1.856241f, 0.521667f},
-   {1.984435f, 1.739388f, 0.997328f},
-   {1.264076f, 1.739388f, 1.160087f},
-   {0.577108f, 1.739388f, 0.855427f},
-   {1.953612f, 1.855257f, 0.942283f},
-   {1.264076f, 1.873808f, 1.094314f},
-   {0.577108f, 1.878915f, 0.855427f},
-   {2.232210f, 1.739388f, 0.220954f},
-   {2.232210f, 1.739388f, -0.513682f},
-   {2.163696f, 1.880411f, 0.242824f},
-   {2.163696f, 1.879185f, -0.451301f},
-   {2.163696f, 1.876077f, 0.631919f},
-   {2.232210f, 1.739388f, 0.631919f},
-};
-
-vec2 falcon_texcoords[] = {
-   {0.515757f, 0.295143f},
-   {0.625000f, 0.500000f},
-   {0.515756f, 0.500000f},
-   {0.515757f, 0.687500f},
-   {0.625000f, 0.750000f},
-   {0.515757f, 0.750000f},
-   {0.170143f, 0.687500f},
-   {0.375000f, 0.750000f},
-   {0.170143f, 0.750000f},
-   {0.375000f, 0.531250f},
-   {0.170143f, 0.562500f},
-   {0.170143f, 0.531250f},
-   {0.375000f, 0.562500f},
-   {0.170143f, 0.625000f},
-   {0.375000f, 0.687500f},
-   {0.625000f, 0.531250f},
-   {0.515757f, 0.562500f},
-   {0.515757f, 0.531250f},
-   {0.625000f, 0.625000f},
-   {0.515757f, 0.625000f},
-   {0.625000f, 0.687500f},
-   {0.197831f, 0.625000f},
-   {0.197831f, 0.687500f},
-   {0.197831f, 0.562500f},
-   {0.197831f, 0.531250f},
-   {0.829857f, 0.625000f},
-   {0.515757f, 0.954857f},
-   {0.375000f, 0.954857f},
-   {0.829857f, 0.562500f},
-   {0.625000f, 0.562500f},
-   {0.375000f, 0.500000f},
-   {0.829857f, 0.750000f},
-   {0.197831f, 0.750000f},
-   {0.375000f, 0.625000f},
-   {0.515757f, 0.322831f},
-   {0.625000f, 0.295143f},
-   {0.625000f, 0.927168f},
-   {0.515757f, 0.875000f},
-   {0.515757f, 0.927169f},
-   {0.802169f, 0.687500f},
-   {0.750000f, 0.750000f},
-   {0.802168f, 0.750000f},
-   {0.750000f, 0.531250f},
-   {0.802169f, 0.562500f},
-   {0.802169f, 0.531250f},
-   {0.750000f, 0.562500f},
-   {0.802169f, 0.625000f},
-   {0.750000f, 0.687500f},
-   {0.375000f, 0.295143f},
-   {0.375000f, 0.322831f},
-   {0.375000f, 0.927168f},
-   {0.375000f, 0.875000f},
-   {0.515757f, 0.375000f},
-   {0.375000f, 0.375000f},
-   {0.829857f, 0.687500f},
-   {0.829857f, 0.531250f},
-   {0.625000f, 0.954857f},
-   {0.625000f, 0.375000f},
-   {0.250000f, 0.687500f},
-   {0.250000f, 0.750000f},
-   {0.250000f, 0.562500f},
-   {0.250000f, 0.531250f},
-   {0.250000f, 0.625000f},
-   {0.197831f, 0.500000f},
-   {0.250000f, 0.500000f},
-   {0.802169f, 0.508413f},
-   {0.829857f, 0.500000f},
-   {0.750000f, 0.500000f},
-   {0.170143f, 0.500000f},
-   {0.634350f, 0.323017f},
-   {0.750000f, 0.625000f},
-   {0.625000f, 0.875000f},
-};
-
-vec3 falcon_normals[] = {
-   {0.513100f, 0.190500f, 0.836900f},
-   {-0.661700f, -0.308400f, 0.683400f},
-   {-0.597400f, -0.264600f, -0.757100f},
-   {-0.000000f, -0.699200f, -0.714900f},
-   {-0.017200f, -0.640200f, -0.768100f},
-   {-0.044800f, -0.338200f, -0.940000f},
-   {0.578000f, -0.298800f, 0.759300f},
-   {-0.049900f, -0.106400f, 0.993100f},
-   {-0.560900f, -0.384700f, 0.733000f},
-   {-0.000000f, -0.062800f, -0.998000f},
-   {-0.000000f, -0.004400f, -1.000000f},
-   {-0.405400f, 0.671900f, 0.619800f},
-   {-0.936900f, -0.282300f, -0.206200f},
-   {-0.014900f, 0.736300f, 0.676400f},
-   {0.956400f, 0.292000f, -0.000000f},
-   {0.303400f, 0.701700f, 0.644600f},
-   {-0.664500f, -0.379000f, 0.644000f},
-   {0.234200f, -0.465100f, 0.853700f},
-   {-0.120100f, -0.759700f, -0.639100f},
-   {-0.745400f, -0.172700f, 0.643800f},
-   {-0.171400f, -0.761700f, -0.624900f},
-   {0.493600f, 0.159700f, 0.854900f},
-   {-0.900400f, -0.210200f, 0.380900f},
-   {-0.787800f, -0.594900f, -0.159500f},
-   {-0.608000f, -0.268300f, 0.747300f},
-   {0.430700f, -0.219800f, 0.875300f},
-   {0.365800f, -0.121000f, 0.922800f},
-   {-0.166100f, -0.150400f, 0.974600f},
-   {0.985300f, -0.170900f, -0.000900f},
-   {-0.960300f, -0.220300f, -0.171300f},
-   {-0.258700f, -0.834900f, 0.485700f},
-   {-0.000000f, -0.508800f, -0.860900f},
-   {-0.476400f, -0.869500f, 0.130300f},
-   {0.041400f, -0.792200f, 0.608900f},
-   {0.283800f, 0.416700f, -0.863600f},
-   {-0.432000f, -0.901900f, 0.004800f},
-   {0.744200f, -0.437700f, 0.504600f},
-   {-0.517800f, -0.849300f, -0.103100f},
-   {1.000000f, -0.000000f, -0.000000f},
-   {-0.110300f, -0.906200f, 0.408300f},
-   {-0.018900f, -0.393000f, 0.919400f},
-   {0.333200f, -0.166600f, 0.928000f},
-   {-0.317300f, -0.858400f, 0.403000f},
-   {-0.480100f, -0.837100f, 0.262400f},
-   {0.636900f, -0.000000f, 0.770900f},
-   {-0.116500f, -0.202900f, -0.972200f},
-   {-0.000000f, -0.015200f, -0.999900f},
-   {0.240000f, -0.000000f, -0.970800f},
-   {0.057300f, 0.031800f, 0.997800f},
-   {0.991600f, 0.123200f, 0.039300f},
-   {0.004400f, -0.049500f, -0.998800f},
-   {0.186000f, -0.017700f, 0.982400f},
-   {0.301200f, -0.390700f, 0.869800f},
-   {0.496600f, 0.221900f, 0.839100f},
-   {0.234200f, -0.040600f, -0.971400f},
-   {0.302400f, -0.176000f, 0.936800f},
-   {0.287700f, -0.211400f, -0.934100f},
-   {0.971300f, -0.237800f, -0.000000f},
-   {0.230100f, 0.493700f, 0.838600f},
-   {0.569700f, -0.806900f, -0.155900f},
-   {0.063900f, -0.008300f, 0.997900f},
-   {0.007600f, 0.688400f, -0.725300f},
-   {0.999000f, -0.020900f, 0.039600f},
-   {-0.000000f, 0.366000f, -0.930600f},
-   {-0.033800f, -0.999400f, -0.011200f},
-   {-0.010600f, -0.999400f, -0.033500f},
-   {-0.000000f, 1.000000f, -0.000000f},
-   {0.048000f, -0.994200f, 0.096300f},
-   {0.202600f, -0.463700f, 0.862500f},
-   {-0.370100f, -0.408300f, 0.834500f},
-   {-0.531900f, -0.592100f, 0.605400f},
-   {-0.075200f, -0.997100f, -0.011400f},
-   {-0.049000f, -0.709700f, -0.702800f},
-   {0.073400f, -0.580400f, -0.811000f},
-   {-0.442800f, -0.896500f, -0.014400f},
-   {0.898000f, -0.440100f, -0.000000f},
-   {0.894000f, -0.448100f, 0.005000f},
-   {0.229600f, -0.973300f, -0.001700f},
-   {0.745500f, -0.539800f, -0.391000f},
-   {0.132000f, -0.979000f, 0.155000f},
-   {0.507300f, -0.218600f, 0.833600f},
-   {-0.681700f, 0.316100f, 0.659800f},
-   {-0.629000f, 0.163400f, -0.760100f},
-   {-0.000000f, 0.699200f, -0.714900f},
-   {-0.017200f, 0.640200f, -0.768100f},
-   {-0.097900f, 0.221300f, -0.970300f},
-   {0.578000f, 0.298800f, 0.759300f},
-   {-0.023600f, 0.048500f, 0.998500f},
-   {-0.511300f, 0.079600f, 0.855700f},
-   {-0.013900f, 0.034000f, -0.999300f},
-   {-0.000000f, 0.004400f, -1.000000f},
-   {-0.405400f, -0.671900f, 0.619800f},
-   {-0.935100f, 0.333000f, -0.121200f},
-   {-0.014900f, -0.736300f, 0.676400f},
-   {0.956400f, -0.292000f, -0.000000f},
-   {0.248000f, -0.624600f, 0.740500f},
-   {-0.610400f, 0.162900f, 0.775200f},
-   {0.556100f, 0.437800f, 0.706400f},
-   {-0.552100f, 0.052300f, -0.832100f},
-   {-0.745400f, 0.172700f, 0.643800f},
-   {-0.086900f, 0.433600f, -0.896900f},
-   {0.605300f, 0.054600f, 0.794100f},
-   {-0.900400f, 0.210200f, 0.380900f},
-   {-0.758100f, 0.644500f, -0.099500f},
-   {-0.589700f, 0.123200f, 0.798200f},
-   {0.430700f, 0.219800f, 0.875300f},
-   {0.365800f, 0.121000f, 0.922800f},
-   {-0.168600f, 0.159200f, 0.972700f},
-   {0.985300f, 0.170900f, -0.000900f},
-   {-0.963600f, 0.186100f, -0.191900f},
-   {-0.258700f, 0.834900f, 0.485700f},
-   {0.129600f, -0.059700f, -0.989800f},
-   {-0.594200f, 0.794900f, -0.122700f},
-   {0.041400f, 0.792200f, 0.608900f},
-   {0.054400f, 0.461300f, -0.885600f},
-   {-0.444700f, 0.895700f, -0.000000f},
-   {0.744200f, 0.437700f, 0.504600f},
-   {-0.523600f, 0.844100f, -0.115200f},
-   {-0.082500f, 0.871000f, 0.484300f},
-   {-0.018900f, 0.393000f, 0.919400f},
-   {0.333200f, 0.166600f, 0.928000f},
-   {-0.317000f, 0.864700f, 0.389600f},
-   {-0.480100f, 0.837100f, 0.262400f},
-   {-0.184600f, 0.014900f, -0.982700f},
-   {-0.000000f, 0.015200f, -0.999900f},
-   {0.057300f, -0.031800f, 0.997800f},
-   {0.004400f, 0.049500f, -0.998800f},
-   {0.186000f, 0.017700f, 0.982400f},
-   {0.301200f, 0.390700f, 0.869800f},
-   {0.496600f, -0.221900f, 0.839100f},
-   {0.234200f, 0.040600f, -0.971400f},
-   {0.302400f, 0.176000f, 0.936800f},
-   {0.287700f, 0.211400f, -0.934100f},
-   {0.971300f, 0.237800f, -0.000000f},
-   {0.230100f, -0.493700f, 0.838600f},
-   {0.403100f, 0.915100f, -0.000000f},
-   {-0.072300f, -0.822800f, 0.563700f},
-   {0.007600f, -0.688400f, -0.725300f},
-   {0.999000f, 0.020900f, 0.039600f},
-   {-0.000000f, -0.366000f, -0.930600f},
-   {-0.033800f, 0.999400f, -0.011200f},
-   {-0.010600f, 0.999400f, -0.033500f},
-   {-0.000000f, -1.000000f, -0.000000f},
-   {0.024600f, 0.988500f, 0.149200f},
-   {0.198900f, 0.430700f, 0.880300f},
-   {-0.370100f, 0.408300f, 0.834500f},
-   {-0.531900f, 0.592100f, 0.605400f},
-   {-0.075200f, 0.997100f, -0.011400f},
-   {-0.049000f, 0.709700f, -0.702800f},
-   {0.073400f, 0.580400f, -0.811000f},
-   {-0.370600f, 0.928800f, 0.004100f},
-   {0.898000f, 0.440100f, -0.000000f},
-   {0.899500f, 0.437000f, -0.000000f},
-   {0.083300f, 0.996000f, -0.030700f},
-   {0.764000f, 0.336100f, -0.550800f},
-   {0.132000f, 0.979000f, 0.155000f},
-   {0.507300f, 0.218600f, 0.833600f},
-   {-0.681700f, -0.316100f, 0.659800f},
-   {-0.629000f, -0.163400f, -0.760100f},
-   {0.056400f, -0.639200f, -0.766900f},
-   {0.181100f, -0.218600f, -0.958900f},
-   {-0.097900f, -0.221300f, -0.970300f},
-   {0.434000f, -0.043700f, 0.899900f},
-   {-0.023600f, -0.048500f, 0.998500f},
-   {-0.511300f, -0.079600f, 0.855700f},
-   {-0.013900f, -0.034000f, -0.999300f},
-   {-0.022300f, -0.034000f, -0.999200f},
-   {-0.255600f, -0.198800f, 0.946100f},
-   {-0.935100f, -0.333000f, -0.121200f},
-   {-0.014000f, 0.735000f, 0.678000f},
-   {0.248000f, 0.624600f, 0.740500f},
-   {-0.610400f, -0.162900f, 0.775200f},
-   {0.556100f, -0.437800f, 0.706400f},
-   {-0.552100f, -0.052300f, -0.832100f},
-   {-0.810300f, -0.383700f, 0.442800f},
-   {-0.086900f, -0.433600f, -0.896900f},
-   {0.605300f, -0.054600f, 0.794100f},
-   {-0.901100f, -0.253000f, 0.352100f},
-   {-0.758100f, -0.644500f, -0.099500f},
-   {-0.589700f, -0.123200f, 0.798200f},
-   {0.373000f, -0.120600f, 0.920000f},
-   {0.374900f, -0.149700f, 0.914900f},
-   {-0.168600f, -0.159200f, 0.972700f},
-   {0.985000f, -0.172700f, -0.000000f},
-   {-0.963600f, -0.186100f, -0.191900f},
-   {-0.321400f, -0.256200f, 0.911600f},
-   {0.129600f, 0.059700f, -0.989800f},
-   {-0.594200f, -0.794900f, -0.122700f},
-   {-0.056900f, -0.894600f, 0.443300f},
-   {0.054400f, -0.461300f, -0.885600f},
-   {-0.444700f, -0.895700f, -0.000000f},
-   {0.754600f, -0.378200f, 0.536200f},
-   {-0.523600f, -0.844100f, -0.115200f},
-   {-0.082500f, -0.871000f, 0.484300f},
-   {0.189200f, -0.858200f, 0.477200f},
-   {0.412200f, -0.358100f, 0.837800f},
-   {-0.317000f, -0.864700f, 0.389600f},
-   {-0.461000f, -0.865700f, 0.195000f},
-   {0.605100f, -0.057500f, 0.794000f},
-   {-0.184600f, -0.014900f, -0.982700f},
-   {0.234200f, -0.014800f, -0.972100f},
-   {0.184500f, -0.172400f, 0.967600f},
-   {0.010400f, -0.051300f, -0.998600f},
-   {0.345700f, -0.228500f, 0.910100f},
-   {0.310100f, -0.370500f, 0.875500f},
-   {0.213200f, 0.629800f, 0.746900f},
-   {0.257900f, -0.004200f, -0.966200f},
-   {0.435300f, -0.329700f, 0.837800f},
-   {0.089500f, -0.693800f, -0.714600f},
-   {0.155200f, -0.020200f, 0.987700f},
-   {0.403100f, -0.915100f, -0.000000f},
-   {-0.072300f, 0.822800f, 0.563700f},
-   {0.079800f, 0.465500f, -0.881500f},
-   {0.999300f, 0.019600f, 0.033300f},
-   {-0.051500f, 0.671600f, -0.739100f},
-   {-0.072300f, -0.996700f, -0.038200f},
-   {-0.006000f, -0.999300f, -0.036200f},
-   {0.024600f, -0.988500f, 0.149200f},
-   {0.198900f, -0.430700f, 0.880300f},
-   {-0.328400f, -0.000000f, 0.944500f},
-   {-0.800600f, -0.000000f, 0.599200f},
-   {-0.029700f, -0.993800f, 0.106800f},
-   {-0.083800f, -0.579900f, -0.810400f},
-   {0.061700f, -0.519900f, -0.852000f},
-   {-0.370600f, -0.928800f, 0.004100f},
-   {0.899400f, -0.437100f, -0.000800f},
-   {0.899500f, -0.437000f, -0.000000f},
-   {0.083300f, -0.996000f, -0.030700f},
-   {0.764000f, -0.336100f, -0.550800f},
-   {0.245800f, -0.969300f, 0.010800f},
-   {0.513100f, -0.190500f, 0.836900f},
-   {-0.661700f, 0.308400f, 0.683400f},
-   {-0.597400f, 0.264600f, -0.757100f},
-   {0.056400f, 0.639200f, -0.766900f},
-   {0.181100f, 0.218600f, -0.958900f},
-   {-0.044800f, 0.338200f, -0.940000f},
-   {0.434000f, 0.043700f, 0.899900f},
-   {-0.049900f, 0.106400f, 0.993100f},
-   {-0.560900f, 0.384700f, 0.733000f},
-   {-0.000000f, 0.062800f, -0.998000f},
-   {-0.022300f, 0.034000f, -0.999200f},
-   {-0.255600f, 0.198800f, 0.946100f},
-   {-0.936900f, 0.282300f, -0.206200f},
-   {-0.014000f, -0.735000f, 0.678000f},
-   {0.303400f, -0.701700f, 0.644600f},
-   {-0.664500f, 0.379000f, 0.644000f},
-   {0.234200f, 0.465100f, 0.853700f},
-   {-0.120100f, 0.759700f, -0.639100f},
-   {-0.810300f, 0.383700f, 0.442800f},
-   {-0.171400f, 0.761700f, -0.624900f},
-   {0.493600f, -0.159700f, 0.854900f},
-   {-0.901100f, 0.253000f, 0.352100f},
-   {-0.787800f, 0.594900f, -0.159500f},
-   {-0.608000f, 0.268300f, 0.747300f},
-   {0.373000f, 0.120600f, 0.920000f},
-   {0.374900f, 0.149700f, 0.914900f},
-   {-0.166100f, 0.150400f, 0.974600f},
-   {0.985000f, 0.172700f, -0.000000f},
-   {-0.960300f, 0.220300f, -0.171300f},
-   {-0.321400f, 0.256200f, 0.911600f},
-   {-0.000000f, 0.508800f, -0.860900f},
-   {-0.476400f, 0.869500f, 0.130300f},
-   {-0.056900f, 0.894600f, 0.443300f},
-   {0.283800f, -0.416700f, -0.863600f},
-   {-0.432000f, 0.901900f, 0.004800f},
-   {0.754600f, 0.378200f, 0.536200f},
-   {-0.517800f, 0.849300f, -0.103100f},
-   {-0.110300f, 0.906200f, 0.408300f},
-   {0.189200f, 0.858200f, 0.477200f},
-   {0.412200f, 0.358100f, 0.837800f},
-   {-0.317300f, 0.858400f, 0.403000f},
-   {-0.461000f, 0.865700f, 0.195000f},
-   {0.605200f, 0.057500f, 0.794000f},
-   {-0.116500f, 0.202900f, -0.972200f},
-   {0.234200f, 0.014800f, -0.972100f},
-   {0.184500f, 0.172400f, 0.967600f},
-   {0.991600f, -0.123200f, 0.039300f},
-   {0.010400f, 0.051300f, -0.998600f},
-   {0.345700f, 0.228500f, 0.910100f},
-   {0.310100f, 0.370500f, 0.875500f},
-   {0.213200f, -0.629800f, 0.746900f},
-   {0.257900f, 0.004200f, -0.966200f},
-   {0.435300f, 0.329700f, 0.837800f},
-   {0.089500f, 0.693800f, -0.714600f},
-   {0.155200f, 0.020200f, 0.987700f},
-   {0.569700f, 0.806900f, -0.155900f},
-   {0.063900f, 0.008300f, 0.997900f},
-   {0.079800f, -0.465500f, -0.881500f},
-   {0.999300f, -0.019600f, 0.033300f},
-   {-0.051500f, -0.671600f, -0.739100f},
-   {-0.072300f, 0.996700f, -0.038200f},
-   {-0.006000f, 0.999300f, -0.036200f},
-   {0.048000f, 0.994200f, 0.096300f},
-   {0.202600f, 0.463700f, 0.862500f},
-   {-0.029700f, 0.993800f, 0.106800f},
-   {-0.083800f, 0.579900f, -0.810400f},
-   {0.061700f, 0.519900f, -0.852000f},
-   {-0.442800f, 0.896500f, -0.014400f},
-   {0.899400f, 0.437100f, -0.000800f},
-   {0.894000f, 0.448100f, 0.005000f},
-   {0.229600f, 0.973300f, -0.001700f},
-   {0.745500f, 0.539800f, -0.391000f},
-   {0.245800f, 0.969300f, 0.010800f},
-};
-
-mesh_asset_face falcon_faces[] = {
-   {{16, 3, 28}, {0, 1, 2}, {0, 0, 0}, 0x0020ccff},
-   {{19, 1, 26}, {3, 4, 5}, {1, 1, 1}, 0x0020ccff},
-   {{27, 0, 14}, {6, 7, 8}, {2, 2, 2}, 0x0020ccff},
-   {{59, 23, 61}, {9, 10, 11}, {3, 3, 3}, 0x0020ccff},
-   {{6, 25, 23}, {12, 13, 10}, {4, 4, 4}, 0x0020ccff},
-   {{25, 4, 27}, {13, 14, 6}, {5, 5, 5}, 0x0020ccff},
-   {{60, 24, 63}, {15, 16, 17}, {6, 6, 6}, 0x0020ccff},
-   {{24, 8, 21}, {16, 18, 19}, {7, 7, 7}, 0x0020ccff},
-   {{21, 9, 19}, {19, 20, 3}, {8, 8, 8}, 0x0020ccff},
-   {{57, 27, 58}, {21, 6, 22}, {9, 9, 9}, 0x0020ccff},
-   {{23, 57, 56}, {10, 21, 23}, {10, 10, 10}, 0x0020ccff},
-   {{61, 56, 69}, {11, 23, 24}, {10, 10, 10}, 0x0020ccff},
-   {{20, 9, 8}, {25, 20, 18}, {11, 11, 11}, 0x0020ccff},
-   {{0, 17, 14}, {7, 26, 27}, {12, 12, 12}, 0x0020ccff},
-   {{18, 8, 7}, {28, 18, 29}, {13, 13, 13}, 0x0020ccff},
-   {{60, 18, 7}, {15, 28, 29}, {15, 15, 15}, 0x0020ccff},
-   {{9, 15, 1}, {20, 31, 4}, {16, 16, 16}, 0x0020ccff},
-   {{63, 44, 67}, {17, 16, 17}, {17, 17, 17}, 0x0020ccff},
-   {{58, 14, 48}, {22, 8, 32}, {18, 18, 18}, 0x0020ccff},
-   {{1, 17, 26}, {4, 26, 5}, {19, 19, 19}, 0x0020ccff},
-   {{4, 43, 42}, {14, 33, 14}, {20, 20, 20}, 0x0020ccff},
-   {{53, 12, 16}, {34, 35, 0}, {21, 21, 21}, 0x0020ccff},
-   {{4, 26, 0}, {14, 5, 7}, {23, 23, 23}, 0x0020ccff},
-   {{64, 49, 68}, {42, 43, 44}, {25, 25, 25}, 0x0020ccff},
-   {{19, 45, 21}, {3, 19, 19}, {30, 30, 30}, 0x0020ccff},
-   {{5, 41, 43}, {33, 12, 33}, {31, 31, 31}, 0x0020ccff},
-   {{19, 42, 46}, {3, 14, 3}, {32, 32, 32}, 0x0020ccff},
-   {{21, 44, 24}, {19, 16, 16}, {33, 33, 33}, 0x0020ccff},
-   {{59, 40, 66}, {9, 30, 9}, {34, 34, 34}, 0x0020ccff},
-   {{45, 72, 71}, {19, 33, 19}, {35, 35, 35}, 0x0020ccff},
-   {{85, 93, 82}, {17, 17, 17}, {36, 36, 36}, 0x0020ccff},
-   {{68, 18, 62}, {44, 28, 55}, {41, 41, 41}, 0x0020ccff},
-   {{30, 53, 13}, {57, 34, 52}, {44, 44, 44}, 0x0020ccff},
-   {{38, 48, 31}, {58, 32, 59}, {45, 45, 45}, 0x0020ccff},
-   {{69, 36, 65}, {24, 60, 61}, {46, 46, 46}, 0x0020ccff},
-   {{56, 37, 36}, {23, 62, 60}, {46, 46, 46}, 0x0020ccff},
-   {{57, 38, 37}, {21, 58, 62}, {46, 46, 46}, 0x0020ccff},
-   {{54, 65, 29}, {63, 61, 64}, {47, 47, 47}, 0x0020ccff},
-   {{47, 62, 12}, {65, 55, 66}, {48, 48, 48}, 0x0020ccff},
-   {{59, 41, 6}, {9, 12, 12}, {50, 50, 50}, 0x0020ccff},
-   {{30, 68, 47}, {67, 44, 65}, {51, 51, 51}, 0x0020ccff},
-   {{63, 39, 28}, {17, 2, 2}, {52, 52, 52}, 0x0020ccff},
-   {{12, 60, 3}, {66, 15, 1}, {53, 53, 53}, 0x0020ccff},
-   {{10, 69, 54}, {68, 24, 63}, {54, 54, 54}, 0x0020ccff},
-   {{3, 63, 28}, {1, 17, 2}, {55, 55, 55}, 0x0020ccff},
-   {{2, 61, 10}, {30, 11, 68}, {56, 56, 56}, 0x0020ccff},
-   {{44, 70, 67}, {16, 17, 17}, {58, 58, 58}, 0x0020ccff},
-   {{44, 71, 75}, {16, 19, 16}, {60, 60, 60}, 0x0020ccff},
-   {{66, 73, 41}, {9, 12, 12}, {61, 61, 61}, 0x0020ccff},
-   {{67, 74, 66}, {17, 9, 9}, {62, 62, 62}, 0x0020ccff},
-   {{41, 72, 43}, {12, 33, 33}, {63, 63, 63}, 0x0020ccff},
-   {{77, 81, 76}, {12, 19, 33}, {64, 64, 64}, 0x0020ccff},
-   {{80, 77, 79}, {17, 12, 9}, {65, 65, 65}, 0x0020ccff},
-   {{70, 89, 74}, {17, 9, 9}, {66, 66, 66}, 0x0020ccff},
-   {{78, 85, 86}, {16, 17, 16}, {67, 67, 67}, 0x0020ccff},
-   {{82, 86, 85}, {17, 16, 17}, {68, 68, 68}, 0x0020ccff},
-   {{84, 86, 83}, {19, 16, 16}, {69, 69, 69}, 0x0020ccff},
-   {{75, 82, 70}, {16, 17, 17}, {66, 66, 66}, 0x0020ccff},
-   {{75, 84, 83}, {16, 19, 16}, {66, 66, 66}, 0x0020ccff},
-   {{81, 84, 71}, {19, 19, 19}, {70, 70, 70}, 0x0020ccff},
-   {{78, 87, 81}, {16, 19, 19}, {71, 71, 71}, 0x0020ccff},
-   {{73, 76, 72}, {12, 33, 33}, {72, 72, 72}, 0x0020ccff},
-   {{74, 77, 73}, {9, 12, 12}, {73, 73, 73}, 0x0020ccff},
-   {{71, 76, 81}, {19, 33, 19}, {74, 74, 74}, 0x0020ccff},
-   {{88, 91, 89}, {17, 9, 9}, {75, 75, 75}, 0x0020ccff},
-   {{90, 93, 92}, {17, 17, 17}, {76, 76, 76}, 0x0020ccff},
-   {{80, 91, 90}, {17, 9, 17}, {77, 77, 77}, 0x0020ccff},
-   {{70, 93, 88}, {17, 17, 17}, {66, 66, 66}, 0x0020ccff},
-   {{79, 89, 91}, {9, 9, 9}, {78, 78, 78}, 0x0020ccff},
-   {{80, 92, 85}, {17, 17, 17}, {79, 79, 79}, 0x0020ccff},
-   {{108, 97, 105}, {0, 1, 35}, {80, 80, 80}, 0x0020ccff},
-   {{111, 95, 103}, {3, 4, 20}, {81, 81, 81}, 0x0020ccff},
-   {{119, 94, 98}, {6, 7, 14}, {82, 82, 82}, 0x0020ccff},
-   {{115, 142, 144}, {10, 9, 11}, {83, 83, 83}, 0x0020ccff},
-   {{117, 100, 115}, {13, 12, 10}, {84, 84, 84}, 0x0020ccff},
-   {{117, 98, 99}, {13, 14, 33}, {85, 85, 85}, 0x0020ccff},
-   {{116, 143, 146}, {16, 15, 17}, {86, 86, 86}, 0x0020ccff},
-   {{116, 102, 101}, {16, 18, 29}, {87, 87, 87}, 0x0020ccff},
-   {{113, 103, 102}, {19, 20, 18}, {88, 88, 88}, 0x0020ccff},
-   {{140, 119, 117}, {21, 6, 13}, {89, 89, 89}, 0x0020ccff},
-   {{140, 115, 139}, {21, 10, 23}, {90, 90, 90}, 0x0020ccff},
-   {{139, 144, 150}, {23, 11, 24}, {90, 90, 90}, 0x0020ccff},
-   {{103, 112, 102}, {20, 25, 18}, {91, 91, 91}, 0x0020ccff},
-   {{94, 109, 118}, {7, 26, 5}, {92, 92, 92}, 0x0020ccff},
-   {{102, 110, 101}, {18, 28, 29}, {93, 93, 93}, 0x0020ccff},
-   {{143, 110, 145}, {15, 28, 55}, {95, 95, 95}, 0x0020ccff},
-   {{103, 107, 114}, {20, 31, 54}, {96, 96, 96}, 0x0020ccff},
-   {{146, 127, 116}, {17, 16, 16}, {97, 97, 97}, 0x0020ccff},
-   {{141, 106, 119}, {22, 8, 6}, {98, 98, 98}, 0x0020ccff},
-   {{109, 95, 118}, {26, 4, 5}, {99, 99, 99}, 0x0020ccff},
-   {{98, 126, 99}, {14, 33, 33}, {100, 100, 100}, 0x0020ccff},
-   {{136, 105, 130}, {34, 35, 69}, {101, 101, 101}, 0x0020ccff},
-   {{98, 118, 111}, {14, 5, 3}, {103, 103, 103}, 0x0020ccff},
-   {{132, 64, 149}, {43, 42, 44}, {105, 105, 105}, 0x0020ccff},
-   {{128, 111, 113}, {19, 3, 19}, {110, 110, 110}, 0x0020ccff},
-   {{99, 124, 100}, {33, 12, 12}, {111, 111, 111}, 0x0020ccff},
-   {{111, 125, 98}, {3, 14, 14}, {112, 112, 112}, 0x0020ccff},
-   {{127, 113, 116}, {16, 19, 16}, {113, 113, 113}, 0x0020ccff},
-   {{142, 123, 96}, {9, 30, 30}, {114, 114, 114}, 0x0020ccff},
-   {{128, 153, 126}, {19, 33, 33}, {115, 115, 115}, 0x0020ccff},
-   {{174, 166, 163}, {17, 17, 17}, {116, 116, 116}, 0x0020ccff},
-   {{110, 149, 145}, {28, 44, 55}, {120, 120, 120}, 0x0020ccff},
-   {{136, 30, 13}, {34, 57, 52}, {44, 44, 44}, 0x0020ccff},
-   {{38, 131, 141}, {58, 32, 22}, {123, 123, 123}, 0x0020ccff},
-   {{36, 150, 65}, {60, 24, 61}, {124, 124, 124}, 0x0020ccff},
-   {{37, 139, 36}, {62, 23, 60}, {124, 124, 124}, 0x0020ccff},
-   {{38, 140, 37}, {58, 21, 62}, {124, 124, 124}, 0x0020ccff},
-   {{65, 137, 121}, {61, 63, 64}, {47, 47, 47}, 0x0020ccff},
-   {{145, 130, 105}, {55, 65, 66}, {125, 125, 125}, 0x0020ccff},
-   {{124, 142, 100}, {12, 9, 12}, {126, 126, 126}, 0x0020ccff},
-   {{149, 30, 130}, {44, 67, 65}, {127, 127, 127}, 0x0020ccff},
-   {{122, 146, 120}, {2, 17, 2}, {128, 128, 128}, 0x0020ccff},
-   {{143, 105, 97}, {15, 66, 1}, {129, 129, 129}, 0x0020ccff},
-   {{150, 104, 137}, {24, 68, 63}, {130, 130, 130}, 0x0020ccff},
-   {{146, 97, 120}, {17, 1, 2}, {131, 131, 131}, 0x0020ccff},
-   {{144, 96, 104}, {11, 30, 68}, {132, 132, 132}, 0x0020ccff},
-   {{151, 127, 148}, {17, 16, 17}, {134, 134, 134}, 0x0020ccff},
-   {{127, 152, 128}, {16, 19, 19}, {136, 136, 136}, 0x0020ccff},
-   {{154, 147, 124}, {12, 9, 12}, {137, 137, 137}, 0x0020ccff},
-   {{155, 148, 147}, {9, 17, 9}, {138, 138, 138}, 0x0020ccff},
-   {{153, 124, 126}, {33, 12, 33}, {139, 139, 139}, 0x0020ccff},
-   {{162, 158, 157}, {19, 12, 33}, {140, 140, 140}, 0x0020ccff},
-   {{158, 161, 160}, {12, 17, 9}, {141, 141, 141}, 0x0020ccff},
-   {{170, 151, 155}, {9, 17, 9}, {142, 142, 142}, 0x0020ccff},
-   {{159, 166, 161}, {16, 17, 17}, {143, 143, 143}, 0x0020ccff},
-   {{163, 167, 164}, {17, 16, 16}, {144, 144, 144}, 0x0020ccff},
-   {{167, 165, 164}, {16, 19, 16}, {145, 145, 145}, 0x0020ccff},
-   {{163, 156, 151}, {17, 16, 17}, {142, 142, 142}, 0x0020ccff},
-   {{156, 165, 152}, {16, 19, 19}, {142, 142, 142}, 0x0020ccff},
-   {{165, 162, 152}, {19, 19, 19}, {146, 146, 146}, 0x0020ccff},
-   {{168, 159, 162}, {19, 16, 19}, {147, 147, 147}, 0x0020ccff},
-   {{157, 154, 153}, {33, 12, 33}, {148, 148, 148}, 0x0020ccff},
-   {{158, 155, 154}, {12, 9, 12}, {149, 149, 149}, 0x0020ccff},
-   {{152, 157, 153}, {19, 33, 33}, {150, 150, 150}, 0x0020ccff},
-   {{172, 169, 170}, {9, 17, 9}, {151, 151, 151}, 0x0020ccff},
-   {{171, 174, 169}, {17, 17, 17}, {152, 152, 152}, 0x0020ccff},
-   {{161, 172, 160}, {17, 9, 9}, {153, 153, 153}, 0x0020ccff},
-   {{151, 174, 163}, {17, 17, 17}, {142, 142, 142}, 0x0020ccff},
-   {{160, 170, 155}, {9, 9, 9}, {154, 154, 154}, 0x0020ccff},
-   {{173, 161, 166}, {17, 17, 17}, {155, 155, 155}, 0x0020ccff},
-   {{16, 12, 3}, {0, 35, 1}, {156, 156, 156}, 0x0020ccff},
-   {{19, 9, 1}, {3, 20, 4}, {157, 157, 157}, 0x0020ccff},
-   {{27, 4, 0}, {6, 14, 7}, {158, 158, 158}, 0x0020ccff},
-   {{59, 6, 23}, {9, 12, 10}, {159, 159, 159}, 0x0020ccff},
-   {{6, 5, 25}, {12, 33, 13}, {160, 160, 160}, 0x0020ccff},
-   {{25, 5, 4}, {13, 33, 14}, {161, 161, 161}, 0x0020ccff},
-   {{60, 7, 24}, {15, 29, 16}, {162, 162, 162}, 0x0020ccff},
-   {{24, 7, 8}, {16, 29, 18}, {163, 163, 163}, 0x0020ccff},
-   {{21, 8, 9}, {19, 18, 20}, {164, 164, 164}, 0x0020ccff},
-   {{57, 25, 27}, {21, 13, 6}, {165, 165, 165}, 0x0020ccff},
-   {{23, 25, 57}, {10, 13, 21}, {166, 166, 166}, 0x0020ccff},
-   {{61, 23, 56}, {11, 10, 23}, {10, 10, 10}, 0x0020ccff},
-   {{20, 22, 9}, {25, 54, 20}, {167, 167, 167}, 0x0020ccff},
-   {{0, 26, 17}, {7, 5, 26}, {168, 168, 168}, 0x0020ccff},
-   {{18, 20, 8}, {28, 25, 18}, {169, 169, 169}, 0x0020ccff},
-   {{60, 62, 18}, {15, 55, 28}, {170, 170, 170}, 0x0020ccff},
-   {{9, 22, 15}, {20, 54, 31}, {171, 171, 171}, 0x0020ccff},
-   {{63, 24, 44}, {17, 16, 16}, {172, 172, 172}, 0x0020ccff},
-   {{58, 27, 14}, {22, 6, 8}, {173, 173, 173}, 0x0020ccff},
-   {{1, 15, 17}, {4, 56, 26}, {174, 174, 174}, 0x0020ccff},
-   {{4, 5, 43}, {14, 33, 33}, {175, 175, 175}, 0x0020ccff},
-   {{53, 47, 12}, {34, 69, 35}, {176, 176, 176}, 0x0020ccff},
-   {{4, 19, 26}, {14, 3, 5}, {178, 178, 178}, 0x0020ccff},
-   {{64, 33, 49}, {42, 45, 43}, {180, 180, 180}, 0x0020ccff},
-   {{19, 46, 45}, {3, 3, 19}, {185, 185, 185}, 0x0020ccff},
-   {{5, 6, 41}, {33, 12, 12}, {186, 186, 186}, 0x0020ccff},
-   {{19, 4, 42}, {3, 14, 14}, {187, 187, 187}, 0x0020ccff},
-   {{21, 45, 44}, {19, 19, 16}, {188, 188, 188}, 0x0020ccff},
-   {{59, 2, 40}, {9, 30, 30}, {189, 189, 189}, 0x0020ccff},
-   {{45, 43, 72}, {19, 33, 33}, {190, 190, 190}, 0x0020ccff},
-   {{85, 92, 93}, {17, 17, 17}, {191, 191, 191}, 0x0020ccff},
-   {{68, 49, 18}, {44, 43, 28}, {195, 195, 195}, 0x0020ccff},
-   {{30, 47, 53}, {57, 69, 34}, {198, 198, 198}, 0x0020ccff},
-   {{38, 58, 48}, {58, 22, 32}, {199, 199, 199}, 0x0020ccff},
-   {{69, 56, 36}, {24, 23, 60}, {46, 46, 46}, 0x0020ccff},
-   {{56, 57, 37}, {23, 21, 62}, {46, 46, 46}, 0x0020ccff},
-   {{57, 58, 38}, {21, 22, 58}, {46, 46, 46}, 0x0020ccff},
-   {{54, 69, 65}, {63, 24, 61}, {200, 200, 200}, 0x0020ccff},
-   {{47, 68, 62}, {65, 44, 55}, {201, 201, 201}, 0x0020ccff},
-   {{59, 66, 41}, {9, 9, 12}, {202, 202, 202}, 0x0020ccff},
-   {{30, 64, 68}, {67, 42, 44}, {203, 203, 203}, 0x0020ccff},
-   {{63, 67, 39}, {17, 17, 2}, {204, 204, 204}, 0x0020ccff},
-   {{12, 62, 60}, {66, 55, 15}, {205, 205, 205}, 0x0020ccff},
-   {{10, 61, 69}, {68, 11, 24}, {206, 206, 206}, 0x0020ccff},
-   {{3, 60, 63}, {1, 15, 17}, {207, 207, 207}, 0x0020ccff},
-   {{2, 59, 61}, {30, 9, 11}, {208, 208, 208}, 0x0020ccff},
-   {{44, 75, 70}, {16, 16, 17}, {209, 209, 209}, 0x0020ccff},
-   {{44, 45, 71}, {16, 19, 19}, {211, 211, 211}, 0x0020ccff},
-   {{66, 74, 73}, {9, 9, 12}, {212, 212, 212}, 0x0020ccff},
-   {{67, 70, 74}, {17, 17, 9}, {213, 213, 213}, 0x0020ccff},
-   {{41, 73, 72}, {12, 12, 33}, {214, 214, 214}, 0x0020ccff},
-   {{77, 78, 81}, {12, 16, 19}, {215, 215, 215}, 0x0020ccff},
-   {{80, 78, 77}, {17, 16, 12}, {216, 216, 216}, 0x0020ccff},
-   {{70, 88, 89}, {17, 17, 9}, {66, 66, 66}, 0x0020ccff},
-   {{78, 80, 85}, {16, 17, 17}, {217, 217, 217}, 0x0020ccff},
-   {{82, 83, 86}, {17, 16, 16}, {218, 218, 218}, 0x0020ccff},
-   {{84, 87, 86}, {19, 19, 16}, {219, 219, 219}, 0x0020ccff},
-   {{75, 83, 82}, {16, 16, 17}, {66, 66, 66}, 0x0020ccff},
-   {{75, 71, 84}, {16, 19, 19}, {66, 66, 66}, 0x0020ccff},
-   {{81, 87, 84}, {19, 19, 19}, {220, 220, 220}, 0x0020ccff},
-   {{78, 86, 87}, {16, 16, 19}, {221, 221, 221}, 0x0020ccff},
-   {{73, 77, 76}, {12, 12, 33}, {222, 222, 222}, 0x0020ccff},
-   {{74, 79, 77}, {9, 9, 12}, {223, 223, 223}, 0x0020ccff},
-   {{71, 72, 76}, {19, 33, 33}, {224, 224, 224}, 0x0020ccff},
-   {{88, 90, 91}, {17, 17, 9}, {225, 225, 225}, 0x0020ccff},
-   {{90, 88, 93}, {17, 17, 17}, {226, 226, 226}, 0x0020ccff},
-   {{80, 79, 91}, {17, 9, 9}, {227, 227, 227}, 0x0020ccff},
-   {{70, 82, 93}, {17, 17, 17}, {66, 66, 66}, 0x0020ccff},
-   {{79, 74, 89}, {9, 9, 9}, {228, 228, 228}, 0x0020ccff},
-   {{80, 90, 92}, {17, 17, 17}, {229, 229, 229}, 0x0020ccff},
-   {{108, 120, 97}, {0, 2, 1}, {230, 230, 230}, 0x0020ccff},
-   {{111, 118, 95}, {3, 5, 4}, {231, 231, 231}, 0x0020ccff},
-   {{119, 106, 94}, {6, 8, 7}, {232, 232, 232}, 0x0020ccff},
-   {{115, 100, 142}, {10, 12, 9}, {233, 233, 233}, 0x0020ccff},
-   {{117, 99, 100}, {13, 33, 12}, {234, 234, 234}, 0x0020ccff},
-   {{117, 119, 98}, {13, 6, 14}, {235, 235, 235}, 0x0020ccff},
-   {{116, 101, 143}, {16, 29, 15}, {236, 236, 236}, 0x0020ccff},
-   {{116, 113, 102}, {16, 19, 18}, {237, 237, 237}, 0x0020ccff},
-   {{113, 111, 103}, {19, 3, 20}, {238, 238, 238}, 0x0020ccff},
-   {{140, 141, 119}, {21, 22, 6}, {239, 239, 239}, 0x0020ccff},
-   {{140, 117, 115}, {21, 13, 10}, {240, 240, 240}, 0x0020ccff},
-   {{139, 115, 144}, {23, 10, 11}, {90, 90, 90}, 0x0020ccff},
-   {{103, 114, 112}, {20, 54, 25}, {241, 241, 241}, 0x0020ccff},
-   {{94, 106, 109}, {7, 27, 26}, {242, 242, 242}, 0x0020ccff},
-   {{102, 112, 110}, {18, 25, 28}, {243, 243, 243}, 0x0020ccff},
-   {{143, 101, 110}, {15, 29, 28}, {244, 244, 244}, 0x0020ccff},
-   {{103, 95, 107}, {20, 4, 31}, {245, 245, 245}, 0x0020ccff},
-   {{146, 148, 127}, {17, 17, 16}, {246, 246, 246}, 0x0020ccff},
-   {{141, 131, 106}, {22, 32, 8}, {247, 247, 247}, 0x0020ccff},
-   {{109, 107, 95}, {26, 56, 4}, {248, 248, 248}, 0x0020ccff},
-   {{98, 125, 126}, {14, 14, 33}, {249, 249, 249}, 0x0020ccff},
-   {{136, 108, 105}, {34, 0, 35}, {250, 250, 250}, 0x0020ccff},
-   {{98, 94, 118}, {14, 7, 5}, {252, 252, 252}, 0x0020ccff},
-   {{132, 33, 64}, {43, 45, 42}, {254, 254, 254}, 0x0020ccff},
-   {{128, 129, 111}, {19, 3, 3}, {259, 259, 259}, 0x0020ccff},
-   {{99, 126, 124}, {33, 33, 12}, {260, 260, 260}, 0x0020ccff},
-   {{111, 129, 125}, {3, 3, 14}, {261, 261, 261}, 0x0020ccff},
-   {{127, 128, 113}, {16, 19, 19}, {262, 262, 262}, 0x0020ccff},
-   {{142, 147, 123}, {9, 9, 30}, {263, 263, 263}, 0x0020ccff},
-   {{128, 152, 153}, {19, 19, 33}, {264, 264, 264}, 0x0020ccff},
-   {{174, 173, 166}, {17, 17, 17}, {265, 265, 265}, 0x0020ccff},
-   {{110, 132, 149}, {28, 43, 44}, {269, 269, 269}, 0x0020ccff},
-   {{136, 130, 30}, {34, 69, 57}, {272, 272, 272}, 0x0020ccff},
-   {{38, 31, 131}, {58, 59, 32}, {273, 273, 273}, 0x0020ccff},
-   {{36, 139, 150}, {60, 23, 24}, {124, 124, 124}, 0x0020ccff},
-   {{37, 140, 139}, {62, 21, 23}, {124, 124, 124}, 0x0020ccff},
-   {{38, 141, 140}, {58, 22, 21}, {124, 124, 124}, 0x0020ccff},
-   {{65, 150, 137}, {61, 24, 63}, {274, 274, 274}, 0x0020ccff},
-   {{145, 149, 130}, {55, 44, 65}, {275, 275, 275}, 0x0020ccff},
-   {{124, 147, 142}, {12, 9, 9}, {277, 277, 277}, 0x0020ccff},
-   {{149, 64, 30}, {44, 42, 67}, {278, 278, 278}, 0x0020ccff},
-   {{122, 148, 146}, {2, 17, 17}, {279, 279, 279}, 0x0020ccff},
-   {{143, 145, 105}, {15, 55, 66}, {280, 280, 280}, 0x0020ccff},
-   {{150, 144, 104}, {24, 11, 68}, {281, 281, 281}, 0x0020ccff},
-   {{146, 143, 97}, {17, 15, 1}, {282, 282, 282}, 0x0020ccff},
-   {{144, 142, 96}, {11, 9, 30}, {283, 283, 283}, 0x0020ccff},
-   {{151, 156, 127}, {17, 16, 16}, {284, 284, 284}, 0x0020ccff},
-   {{127, 156, 152}, {16, 16, 19}, {286, 286, 286}, 0x0020ccff},
-   {{154, 155, 147}, {12, 9, 9}, {287, 287, 287}, 0x0020ccff},
-   {{155, 151, 148}, {9, 17, 17}, {288, 288, 288}, 0x0020ccff},
-   {{153, 154, 124}, {33, 12, 12}, {289, 289, 289}, 0x0020ccff},
-   {{162, 159, 158}, {19, 16, 12}, {290, 290, 290}, 0x0020ccff},
-   {{158, 159, 161}, {12, 16, 17}, {291, 291, 291}, 0x0020ccff},
-   {{170, 169, 151}, {9, 17, 17}, {142, 142, 142}, 0x0020ccff},
-   {{159, 167, 166}, {16, 16, 17}, {292, 292, 292}, 0x0020ccff},
-   {{163, 166, 167}, {17, 17, 16}, {293, 293, 293}, 0x0020ccff},
-   {{167, 168, 165}, {16, 19, 19}, {219, 219, 219}, 0x0020ccff},
-   {{163, 164, 156}, {17, 16, 16}, {142, 142, 142}, 0x0020ccff},
-   {{156, 164, 165}, {16, 16, 19}, {142, 142, 142}, 0x0020ccff},
-   {{165, 168, 162}, {19, 19, 19}, {220, 220, 220}, 0x0020ccff},
-   {{168, 167, 159}, {19, 16, 16}, {294, 294, 294}, 0x0020ccff},
-   {{157, 158, 154}, {33, 12, 12}, {295, 295, 295}, 0x0020ccff},
-   {{158, 160, 155}, {12, 9, 9}, {296, 296, 296}, 0x0020ccff},
-   {{152, 162, 157}, {19, 19, 33}, {297, 297, 297}, 0x0020ccff},
-   {{172, 171, 169}, {9, 17, 17}, {298, 298, 298}, 0x0020ccff},
-   {{171, 173, 174}, {17, 17, 17}, {299, 299, 299}, 0x0020ccff},
-   {{161, 171, 172}, {17, 17, 9}, {300, 300, 300}, 0x0020ccff},
-   {{151, 169, 174}, {17, 17, 17}, {142, 142, 142}, 0x0020ccff},
-   {{160, 172, 170}, {9, 9, 9}, {301, 301, 301}, 0x0020ccff},
-   {{173, 171, 161}, {17, 17, 17}, {302, 302, 302}, 0x0020ccff},
-   {{55, 11, 52}, {36, 37, 38}, {22, 22, 22}, 0x09cc28ff},
-   {{51, 32, 55}, {39, 40, 41}, {24, 24, 24}, 0x09cc28ff},
-   {{33, 50, 49}, {45, 46, 43}, {26, 26, 26}, 0x09cc28ff},
-   {{50, 35, 51}, {46, 47, 39}, {27, 27, 27}, 0x09cc28ff},
-   {{48, 11, 31}, {50, 37, 51}, {29, 29, 29}, 0x09cc28ff},
-   {{14, 52, 48}, {27, 38, 50}, {37, 37, 37}, 0x09cc28ff},
-   {{20, 51, 22}, {25, 39, 54}, {39, 39, 39}, 0x09cc28ff},
-   {{49, 20, 18}, {43, 25, 28}, {40, 40, 40}, 0x09cc28ff},
-   {{22, 55, 15}, {54, 41, 31}, {42, 42, 42}, 0x09cc28ff},
-   {{15, 52, 17}, {56, 38, 26}, {43, 43, 43}, 0x09cc28ff},
-   {{11, 138, 135}, {37, 36, 38}, {102, 102, 102}, 0x09cc28ff},
-   {{134, 32, 35}, {39, 40, 47}, {104, 104, 104}, 0x09cc28ff},
-   {{133, 33, 132}, {46, 45, 43}, {106, 106, 106}, 0x09cc28ff},
-   {{133, 35, 34}, {46, 47, 70}, {107, 107, 107}, 0x09cc28ff},
-   {{131, 11, 135}, {50, 37, 38}, {109, 109, 109}, 0x09cc28ff},
-   {{106, 135, 109}, {27, 38, 26}, {117, 117, 117}, 0x09cc28ff},
-   {{112, 134, 133}, {25, 39, 46}, {118, 118, 118}, 0x09cc28ff},
-   {{112, 132, 110}, {25, 43, 28}, {119, 119, 119}, 0x09cc28ff},
-   {{114, 138, 134}, {54, 41, 39}, {121, 121, 121}, 0x09cc28ff},
-   {{135, 107, 109}, {38, 56, 26}, {122, 122, 122}, 0x09cc28ff},
-   {{55, 32, 11}, {36, 71, 37}, {177, 177, 177}, 0x09cc28ff},
-   {{51, 35, 32}, {39, 47, 40}, {179, 179, 179}, 0x09cc28ff},
-   {{33, 34, 50}, {45, 70, 46}, {181, 181, 181}, 0x09cc28ff},
-   {{50, 34, 35}, {46, 70, 47}, {182, 182, 182}, 0x09cc28ff},
-   {{48, 52, 11}, {50, 38, 37}, {184, 184, 184}, 0x09cc28ff},
-   {{14, 17, 52}, {27, 26, 38}, {192, 192, 192}, 0x09cc28ff},
-   {{20, 50, 51}, {25, 46, 39}, {193, 193, 193}, 0x09cc28ff},
-   {{49, 50, 20}, {43, 46, 25}, {194, 194, 194}, 0x09cc28ff},
-   {{22, 51, 55}, {54, 39, 41}, {196, 196, 196}, 0x09cc28ff},
-   {{15, 55, 52}, {56, 36, 38}, {197, 197, 197}, 0x09cc28ff},
-   {{11, 32, 138}, {37, 71, 36}, {251, 251, 251}, 0x09cc28ff},
-   {{134, 138, 32}, {39, 41, 40}, {253, 253, 253}, 0x09cc28ff},
-   {{133, 34, 33}, {46, 70, 45}, {255, 255, 255}, 0x09cc28ff},
-   {{133, 134, 35}, {46, 39, 47}, {256, 256, 256}, 0x09cc28ff},
-   {{131, 31, 11}, {50, 51, 37}, {258, 258, 258}, 0x09cc28ff},
-   {{106, 131, 135}, {27, 50, 38}, {266, 266, 266}, 0x09cc28ff},
-   {{112, 114, 134}, {25, 54, 39}, {267, 267, 267}, 0x09cc28ff},
-   {{112, 133, 132}, {25, 46, 43}, {268, 268, 268}, 0x09cc28ff},
-   {{114, 107, 138}, {54, 31, 41}, {270, 270, 270}, 0x09cc28ff},
-   {{135, 138, 107}, {38, 36, 56}, {271, 271, 271}, 0x09cc28ff},
-   {{2, 39, 40}, {30, 2, 30}, {14, 14, 14}, 0x02030bff},
-   {{53, 10, 54}, {34, 48, 49}, {28, 28, 28}, 0x02030bff},
-   {{13, 54, 29}, {52, 49, 53}, {38, 38, 38}, 0x02030bff},
-   {{40, 67, 66}, {30, 17, 9}, {49, 49, 49}, 0x02030bff},
-   {{2, 16, 28}, {30, 0, 2}, {57, 57, 57}, 0x02030bff},
-   {{42, 45, 46}, {14, 19, 3}, {59, 59, 59}, 0x02030bff},
-   {{96, 122, 120}, {30, 2, 2}, {94, 94, 94}, 0x02030bff},
-   {{104, 136, 137}, {48, 34, 49}, {108, 108, 108}, 0x02030bff},
-   {{137, 13, 121}, {49, 52, 53}, {38, 38, 38}, 0x02030bff},
-   {{123, 148, 122}, {30, 17, 2}, {38, 38, 38}, 0x02030bff},
-   {{108, 96, 120}, {0, 30, 2}, {133, 133, 133}, 0x02030bff},
-   {{125, 128, 126}, {14, 19, 33}, {135, 135, 135}, 0x02030bff},
-   {{2, 28, 39}, {30, 2, 2}, {14, 14, 14}, 0x02030bff},
-   {{53, 16, 10}, {34, 0, 48}, {183, 183, 183}, 0x02030bff},
-   {{13, 53, 54}, {52, 34, 49}, {38, 38, 38}, 0x02030bff},
-   {{40, 39, 67}, {30, 2, 17}, {38, 38, 38}, 0x02030bff},
-   {{2, 10, 16}, {30, 48, 0}, {57, 57, 57}, 0x02030bff},
-   {{42, 43, 45}, {14, 33, 19}, {210, 210, 210}, 0x02030bff},
-   {{96, 123, 122}, {30, 30, 2}, {94, 94, 94}, 0x02030bff},
-   {{104, 108, 136}, {48, 0, 34}, {257, 257, 257}, 0x02030bff},
-   {{137, 136, 13}, {49, 34, 52}, {38, 38, 38}, 0x02030bff},
-   {{123, 147, 148}, {30, 9, 17}, {276, 276, 276}, 0x02030bff},
-   {{108, 104, 96}, {0, 48, 30}, {133, 133, 133}, 0x02030bff},
-   {{125, 129, 128}, {14, 3, 19}, {285, 285, 285}, 0x02030bff},
-};
-
-static void load_assets(game_context *game)
+   bool result = (offset <= limit && size <= (limit - offset));
+   return(result);
+}
+
+static bool resolve_mesh(mesh_asset *mesh, u8 *data, asset_pack_mesh *record)
+{
+   // NOTE: Point the mesh directly at its blob. Nothing is parsed or copied
+   // beyond the record itself.
+   u64 data_size = record->data_size;
+
+   memsize vertex_size = (record->vertex_format == MESHVERTEX_PACKED) ? sizeof(mesh_asset_packed_vertex) : sizeof(mesh_asset_vertex);
+   if(!pack_range_valid(record->vertices_offset, (u64)record->vertex_count * vertex_size, data_size) ||
+      record->lod_count < 1 || record->lod_count > MESH_LOD_COUNT_MAX ||
+      record->texture_count > MESH_TEXTURE_COUNT_MAX)
+   {
+      return(false);
+   }
+
+   *mesh = {};
+   mesh->vertex_format = (mesh_vertex_format)record->vertex_format;
+   mesh->vertex_count = record->vertex_count;
+   mesh->vertices = (mesh_asset_vertex *)(data + record->vertices_offset);
+   mesh->position_offset = record->position_offset;
+   mesh->position_scale = record->position_scale;
+   mesh->texcoord_offset = record->texcoord_offset;
+   mesh->texcoord_scale = record->texcoord_scale;
+   mesh->radius = record->radius;
+   mesh->lod_count = record->lod_count;
+
+   for(int lod_index = 0; lod_index < mesh->lod_count; ++lod_index)
+   {
+      asset_pack_lod *source = record->lods + lod_index;
+      if(!pack_range_valid(source->faces_offset, (u64)source->face_count * sizeof(mesh_asset_face), data_size) ||
+         !pack_range_valid(source->meshlets_offset, (u64)source->meshlet_count * sizeof(mesh_asset_meshlet), data_size) ||
+         !pack_range_valid(source->vertex_offset, source->vertex_count, record->vertex_count))
+      {
+         return(false);
+      }
+
+      mesh_asset_lod *lod = mesh->lods + lod_index;
+      lod->error = source->error;
+      lod->vertex_offset = source->vertex_offset;
+      lod->vertex_count = source->vertex_count;
+      lod->face_count = source->face_count;
+      lod->faces = (mesh_asset_face *)(data + source->faces_offset);
+      lod->meshlet_count = source->meshlet_count;
+      lod->meshlets = (mesh_asset_meshlet *)(data + source->meshlets_offset);
+
+      // NOTE: Rendering indexes with these directly, so check them once here.
+      for(int face_index = 0; face_index < lod->face_count; ++face_index)
+      {
+         mesh_asset_face *face = lod->faces + face_index;
+         for(int corner = 0; corner < 3; ++corner)
+         {
+            if(face->vertex_indices[corner] < 0 || face->vertex_indices[corner] >= lod->vertex_count)
+            {
+               return(false);
+            }
+         }
+
+         if(face->texture_index < -1 || face->texture_index >= (int)record->texture_count)
+         {
+            return(false);
+         }
+      }
+
+      for(int meshlet_index = 0; meshlet_index < lod->meshlet_count; ++meshlet_index)
+      {
+         mesh_asset_meshlet *meshlet = lod->meshlets + meshlet_index;
+         if(meshlet->face_offset < 0 || meshlet->face_count < 0 ||
+            !pack_range_valid(meshlet->face_offset, meshlet->face_count, lod->face_count))
+         {
+            return(false);
+         }
+      }
+   }
+
+   mesh->face_count = mesh->lods[0].face_count;
+   mesh->faces = mesh->lods[0].faces;
+
+   mesh->texture_count = record->texture_count;
+   for(int texture_index = 0; texture_index < mesh->texture_count; ++texture_index)
+   {
+      asset_pack_texture *source = record->textures + texture_index;
+      if(source->width_log2 >= TEXTURE_MIP_COUNT_MAX || source->height_log2 >= TEXTURE_MIP_COUNT_MAX ||
+         source->mip_count != MAXIMUM(source->width_log2, source->height_log2) + 1)
+      {
+         return(false);
+      }
+
+      mesh_asset_texture *texture = mesh->textures + texture_index;
+      texture->width_log2 = source->width_log2;
+      texture->height_log2 = source->height_log2;
+      texture->mip_count = source->mip_count;
+
+      u64 offset = source->texels_offset;
+      for(int mip_index = 0; mip_index < texture->mip_count; ++mip_index)
+      {
+         int width_log2 = MAXIMUM(texture->width_log2 - mip_index, 0);
+         int height_log2 = MAXIMUM(texture->height_log2 - mip_index, 0);
+         u64 size = sizeof(u32) << (width_log2 + height_log2);
+         if(!pack_range_valid(offset, size, data_size))
+         {
+            return(false);
+         }
+
+         texture->mips[mip_index] = (u32 *)(data + offset);
+         offset += size;
+      }
+   }
+
+   return(true);
+}
+
+static bool validate_mesh_record(asset_pack_mesh *record, u64 pack_size)
 {
-   assert(0 < countof(game->entities));
-   game->meshes[0].vertex_count   = countof(cube_vertices);
-   game->meshes[0].vertices       = cube_vertices;
-   game->meshes[0].texcoord_count = countof(cube_texcoords);
-   game->meshes[0].texcoords      = cube_texcoords;
-   game->meshes[0].normal_count   = countof(cube_normals);
-   game->meshes[0].normals        = cube_normals;
-   game->meshes[0].face_count     = countof(cube_faces);
-   game->meshes[0].faces          = cube_faces;
-
-   assert(1 < countof(game->entities));
-   game->meshes[1].vertex_count   = countof(falcon_vertices);
-   game->meshes[1].vertices       = falcon_vertices;
-   game->meshes[1].texcoord_count = countof(falcon_texcoords);
-   game->meshes[1].texcoords      = falcon_texcoords;
-   game->meshes[1].normal_count   = countof(falcon_normals);
-   game->meshes[1].normals        = falcon_normals;
-   game->meshes[1].face_count     = countof(falcon_faces);
-   game->meshes[1].faces          = falcon_faces;
+   // NOTE: Check everything a load depends on up front, so streaming only has
+   // to deal with the contents of a blob.
+   if(!pack_range_valid(record->data_offset, record->stored_size, pack_size) ||
+      record->lod_count < 1 || record->lod_count > MESH_LOD_COUNT_MAX)
+   {
+      return(false);
+   }
+
+   if(record->chunk_count == 0)
+   {
+      return(record->stored_size == record->data_size);
+   }
+
+   u64 chunk_count = (record->data_size + ASSET_PACK_CHUNK_SIZE - 1) / ASSET_PACK_CHUNK_SIZE;
+   bool result = (record->chunk_count == chunk_count &&
+                  pack_range_valid(0, chunk_count * sizeof(asset_pack_chunk), record->stored_size));
+
+   return(result);
+}
+
+static bool validate_chunk_table(asset_pack_mesh *record, asset_pack_chunk *chunks)
+{
+   // NOTE: The table is only available once the stored blob has been read.
+   for(u32 chunk_index = 0; chunk_index < record->chunk_count; ++chunk_index)
+   {
+      if(!pack_range_valid(chunks[chunk_index].offset, chunks[chunk_index].compressed_size, record->stored_size))
+      {
+         return(false);
+      }
+   }
+
+   return(true);
+}
+
+static bool read_pack_immediately(platform_file *pack, u64 offset, u64 size, void *dest)
+{
+   // NOTE: Only used when opening the pack, for the header and mesh table.
+   platform_read read = {};
+   read.file = *pack;
+   read.offset = offset;
+   read.size = size;
+   read.dest = dest;
+
+   platform_read_file(&read);
+   while(ATOMIC_LOAD(&read.status) == PLATFORMREAD_PENDING)
+   {
+      platform_poll_reads();
+   }
+
+   bool result = (read.status == PLATFORMREAD_COMPLETE);
+   return(result);
+}
+
+static asset_pack_mesh *read_asset_pack(memarena *arena, platform_file *pack, int *mesh_count)
+{
+   // NOTE: Open the pack and read its mesh table into the arena. The file is
+   // left open only if every record is valid.
+   if(!platform_open_file(pack, ASSET_PACK_PATH))
+   {
+      platform_log("ERROR: Failed to open the asset pack %s.\n", ASSET_PACK_PATH);
+      return(0);
+   }
+
+   asset_pack_header header = {};
+   if(pack->size < sizeof(header) ||
+      !read_pack_immediately(pack, 0, sizeof(header), &header) ||
+      header.magic != ASSET_PACK_MAGIC ||
+      header.version != ASSET_PACK_VERSION ||
+      header.size != pack->size ||
+      !pack_range_valid(header.mesh_table_offset, (u64)header.mesh_count * sizeof(asset_pack_mesh), pack->size))
+   {
+      platform_log("ERROR: The asset pack %s is invalid or out of date.\n", ASSET_PACK_PATH);
+      platform_close_file(pack);
+      return(0);
+   }
+
+   asset_pack_mesh *records = arena_array(arena, asset_pack_mesh, header.mesh_count);
+   if(!records || !read_pack_immediately(pack, header.mesh_table_offset, (u64)header.mesh_count * sizeof(asset_pack_mesh), records))
+   {
+      platform_log("ERROR: Failed to read the asset pack %s.\n", ASSET_PACK_PATH);
+      platform_close_file(pack);
+      return(0);
+   }
+
+   for(u32 mesh_index = 0; mesh_index < header.mesh_count; ++mesh_index)
+   {
+      if(!validate_mesh_record(records + mesh_index, pack->size))
+      {
+         platform_log("ERROR: Mesh %d in the asset pack %s is corrupt.\n", mesh_index, ASSET_PACK_PATH);
+         platform_close_file(pack);
+         return(0);
+      }
+   }
+
+   *mesh_count = header.mesh_count;
+   return(records);
+}
+
+static bool reserve_stream_jobs(memarena *arena, mesh_stream *stream, asset_pack_mesh *record)
+{
+   // NOTE: Only compressed blobs need chunk jobs, and each chunk gets one.
+   if(record->chunk_count > (u32)stream->job_capacity)
+   {
+      stream->jobs = arena_array(arena, stream_chunk_job, record->chunk_count);
+      stream->job_capacity = stream->jobs ? record->chunk_count : 0;
+   }
+
+   bool result = (record->chunk_count <= (u32)stream->job_capacity);
+   return(result);
+}
+
+static bool load_assets(game_context *game, u64 budget)
+{
+   // NOTE: The mesh table is read into frame memory, and each record is kept
+   // alongside its stream.
+   asset_streamer *streamer = &game->streamer;
+   platform_file *pack = &streamer->pack;
+
+   int mesh_count = 0;
+   asset_pack_mesh *records = read_asset_pack(&game->frame, pack, &mesh_count);
+   if(!records)
+   {
+      return(false);
+   }
+
+   streamer->pack_time = platform_get_file_time(ASSET_PACK_PATH);
+   streamer->pool_size = budget;
+   streamer->pool = (u8 *)arena_allocate_aligned(&game->perma, budget, ASSET_PACK_ALIGNMENT);
+   streamer->allocations = arena_array(&game->perma, int, mesh_count);
+   streamer->streams = arena_array(&game->perma, mesh_stream, mesh_count);
+
+   game->mesh_count = mesh_count;
+   game->meshes = arena_array(&game->perma, mesh_asset, mesh_count);
+
+   bool result = (streamer->pool && streamer->allocations && streamer->streams && game->meshes);
+   for(int mesh_index = 0; result && mesh_index < mesh_count; ++mesh_index)
+   {
+      asset_pack_mesh *record = records + mesh_index;
+      mesh_stream *stream = streamer->streams + mesh_index;
+      result = reserve_stream_jobs(&game->perma, stream, record);
+      stream->record = *record;
+      stream->job_count = record->chunk_count;
+
+      // NOTE: The bounds are needed to cull and size fallbacks before the mesh
+      // itself is resident.
+      game->meshes[mesh_index] = {};
+      game->meshes[mesh_index].radius = record->radius;
+   }
+
+   if(!result)
+   {
+      platform_log("ERROR: Failed to allocate the asset streamer.\n");
+      platform_close_file(pack);
+   }
+
+   return(result);
+}
+
+static void load_chunk(void *data)
+{
+   stream_chunk_job *job = (stream_chunk_job *)data;
+   mesh_stream *stream = job->stream;
+
+   if(job->compressed_size == job->size)
+   {
+      memcpy(job->dest, job->source, job->size);
+   }
+   else if(lz4_decompress(job->source, job->compressed_size, job->dest, job->size) != (int)job->size)
+   {
+      ATOMIC_STORE(&stream->failed, 1u);
+   }
+
+   // NOTE: The last chunk to finish hands the mesh back to the main thread.
+   if(ATOMIC_DECREMENT(&stream->chunks_remaining) == 0)
+   {
+      ATOMIC_STORE(&stream->residency, (u32)MESHRESIDENCY_LOADED);
+   }
+}
+
+static u64 align_stream_size(u64 size)
+{
+   u64 result = (size + ASSET_PACK_ALIGNMENT - 1) & ~(u64)(ASSET_PACK_ALIGNMENT - 1);
+   return(result);
+}
+
+static bool allocate_stream_memory(asset_streamer *streamer, int mesh_index, u64 size)
+{
+   // NOTE: First fit over the gaps between existing allocations, which are
+   // kept sorted by offset.
+   size = align_stream_size(size);
+
+   u64 gap_start = 0;
+   int insert_index = 0;
+   for(; insert_index <= streamer->allocation_count; ++insert_index)
+   {
+      u64 gap_end = streamer->pool_size;
+      if(insert_index < streamer->allocation_count)
+      {
+         gap_end = streamer->streams[streamer->allocations[insert_index]].pool_offset;
+      }
+
+      if(gap_end - gap_start >= size)
+      {
+         break;
+      }
+
+      if(insert_index < streamer->allocation_count)
+      {
+         mesh_stream *previous = streamer->streams + streamer->allocations[insert_index];
+         gap_start = previous->pool_offset + previous->pool_size;
+      }
+   }
+
+   bool result = (insert_index <= streamer->allocation_count);
+   if(result)
+   {
+      for(int index = streamer->allocation_count; index > insert_index; --index)
+      {
+         streamer->allocations[index] = streamer->allocations[index - 1];
+      }
+      streamer->allocations[insert_index] = mesh_index;
+      streamer->allocation_count++;
+      streamer->pool_used += size;
+
+      mesh_stream *stream = streamer->streams + mesh_index;
+      stream->pool_offset = gap_start;
+      stream->pool_size = size;
+   }
+
+   return(result);
+}
+
+static void free_stream_memory(asset_streamer *streamer, int mesh_index)
+{
+   for(int index = 0; index < streamer->allocation_count; ++index)
+   {
+      if(streamer->allocations[index] == mesh_index)
+      {
+         streamer->allocation_count--;
+         for(; index < streamer->allocation_count; ++index)
+         {
+            streamer->allocations[index] = streamer->allocations[index + 1];
+         }
+         break;
+      }
+   }
+
+   mesh_stream *stream = streamer->streams + mesh_index;
+   streamer->pool_used -= stream->pool_size;
+   stream->pool_offset = 0;
+   stream->pool_size = 0;
+}
+
+static void shrink_stream_memory(asset_streamer *streamer, int mesh_index, u64 size)
+{
+   // NOTE: Giving back the end of a range keeps the allocations sorted.
+   mesh_stream *stream = streamer->streams + mesh_index;
+   size = align_stream_size(size);
+   assert(size <= stream->pool_size);
+
+   streamer->pool_used -= stream->pool_size - size;
+   stream->pool_size = size;
+}
+
+static void evict_mesh(game_context *game, int mesh_index)
+{
+   mesh_stream *stream = game->streamer.streams + mesh_index;
+   assert(stream->residency == MESHRESIDENCY_RESIDENT);
+
+   free_stream_memory(&game->streamer, mesh_index);
+   stream->residency = MESHRESIDENCY_UNLOADED;
+
+   float radius = game->meshes[mesh_index].radius;
+   game->meshes[mesh_index] = {};
+   game->meshes[mesh_index].radius = radius;
+}
+
+static bool evict_least_recent_mesh(game_context *game)
+{
+   // NOTE: Meshes requested this frame are never evicted, which keeps the
+   // streamer from thrashing when the budget is too small for the view.
+   asset_streamer *streamer = &game->streamer;
+
+   int victim = -1;
+   for(int mesh_index = 0; mesh_index < game->mesh_count; ++mesh_index)
+   {
+      mesh_stream *stream = streamer->streams + mesh_index;
+      if(stream->residency == MESHRESIDENCY_RESIDENT && stream->last_requested_frame != streamer->frame_index)
+      {
+         if(victim < 0 || stream->last_requested_frame < streamer->streams[victim].last_requested_frame)
+         {
+            victim = mesh_index;
+         }
+      }
+   }
+
+   if(victim >= 0)
+   {
+      evict_mesh(game, victim);
+   }
+
+   return(victim >= 0);
+}
+
+static bool begin_mesh_load(game_context *game, int mesh_index)
+{
+   asset_streamer *streamer = &game->streamer;
+   mesh_stream *stream = streamer->streams + mesh_index;
+   asset_pack_mesh *record = &stream->record;
+
+   // NOTE: Compressed blobs are read in behind the space they decompress to.
+   u64 data_size = align_stream_size(record->data_size);
+   u64 size = data_size;
+   if(record->chunk_count)
+   {
+      size += record->stored_size;
+   }
+
+   if(size > streamer->pool_size)
+   {
+      return(false);
+   }
+
+   while(!allocate_stream_memory(streamer, mesh_index, size))
+   {
+      if(!evict_least_recent_mesh(game))
+      {
+         return(false);
+      }
+   }
+
+   u8 *dest = streamer->pool + stream->pool_offset;
+   if(record->chunk_count)
+   {
+      dest += data_size;
+   }
+
+   stream->read = {};
+   stream->read.file = streamer->pack;
+   stream->read.offset = record->data_offset;
+   stream->read.size = record->stored_size;
+   stream->read.dest = dest;
+
+   stream->residency = MESHRESIDENCY_READING;
+   streamer->reads_in_flight++;
+   streamer->chunk_jobs_in_flight += stream->job_count;
+
+   platform_read_file(&stream->read);
+
+   return(true);
+}
+
+static void fail_mesh_load(game_context *game, int mesh_index, bool corrupt)
+{
+   asset_streamer *streamer = &game->streamer;
+   mesh_stream *stream = streamer->streams + mesh_index;
+
+   if(corrupt)
+   {
+      platform_log("ERROR: Mesh %.*s in the asset pack %s is corrupt.\n", ASSET_NAME_LENGTH, stream->record.name, ASSET_PACK_PATH);
+   }
+   else
+   {
+      platform_log("ERROR: Failed to stream mesh %.*s.\n", ASSET_NAME_LENGTH, stream->record.name);
+   }
+
+   streamer->chunk_jobs_in_flight -= stream->job_count;
+   free_stream_memory(streamer, mesh_index);
+   stream->residency = MESHRESIDENCY_FAILED;
+
+   float radius = game->meshes[mesh_index].radius;
+   game->meshes[mesh_index] = {};
+   game->meshes[mesh_index].radius = radius;
+}
+
+static void begin_mesh_decompression(game_context *game, int mesh_index)
+{
+   asset_streamer *streamer = &game->streamer;
+   mesh_stream *stream = streamer->streams + mesh_index;
+   asset_pack_mesh *record = &stream->record;
+
+   u8 *stored = (u8 *)stream->read.dest;
+   u8 *dest = streamer->pool + stream->pool_offset;
+   asset_pack_chunk *chunks = (asset_pack_chunk *)stored;
+   if(!validate_chunk_table(record, chunks))
+   {
+      fail_mesh_load(game, mesh_index, true);
+      return;
+   }
+
+   stream->failed = 0;
+   stream->chunks_remaining = stream->job_count;
+   stream->residency = MESHRESIDENCY_DECOMPRESSING;
+
+   for(int job_index = 0; job_index < stream->job_count; ++job_index)
+   {
+      u64 offset = (u64)job_index * ASSET_PACK_CHUNK_SIZE;
+
+      stream_chunk_job *job = stream->jobs + job_index;
+      job->stream = stream;
+      job->dest = dest + offset;
+      job->size = (u32)MINIMUM(record->data_size - offset, ASSET_PACK_CHUNK_SIZE);
+      job->source = stored + chunks[job_index].offset;
+      job->compressed_size = chunks[job_index].compressed_size;
+
+      platform_enqueue_work(load_chunk, job);
+   }
+}
+
+static void finish_mesh_load(game_context *game, int mesh_index)
+{
+   asset_streamer *streamer = &game->streamer;
+   mesh_stream *stream = streamer->streams + mesh_index;
+
+   u8 *data = streamer->pool + stream->pool_offset;
+   if(stream->failed)
+   {
+      fail_mesh_load(game, mesh_index, false);
+      return;
+   }
+
+   if(!resolve_mesh(game->meshes + mesh_index, data, &stream->record))
+   {
+      fail_mesh_load(game, mesh_index, true);
+      return;
+   }
+
+   // NOTE: The compressed copy at the end of the range is no longer needed.
+   streamer->chunk_jobs_in_flight -= stream->job_count;
+   shrink_stream_memory(streamer, mesh_index, stream->record.data_size);
+   stream->residency = MESHRESIDENCY_RESIDENT;
+
+   // NOTE: Impostors are baked the first time a mesh arrives and outlive its
+   // eviction, so they can stand in for it while it reloads.
+   if(!stream->impostor_baked)
+   {
+      bake_mesh_impostors(game, mesh_index);
+      stream->impostor_baked = true;
+   }
+}
+
+static bool mesh_is_resident(game_context *game, int mesh_index)
+{
+   bool result = (game->streamer.streams[mesh_index].residency == MESHRESIDENCY_RESIDENT);
+   return(result);
+}
+
+static void reload_asset_pack(game_context *game)
+{
+   // NOTE: Reads already in flight refer to the old pack and its records, so
+   // the swap waits until every load has finished.
+   asset_streamer *streamer = &game->streamer;
+   if(streamer->reads_in_flight > 0 || streamer->chunk_jobs_in_flight > 0)
+   {
+      return;
+   }
+
+   u64 pack_time = platform_get_file_time(ASSET_PACK_PATH);
+   if(pack_time == streamer->pack_time)
+   {
+      return;
+   }
+
+   // NOTE: Failures are only reported once per change to the pack.
+   streamer->pack_time = pack_time;
+
+   platform_file pack = {};
+   int mesh_count = 0;
+   asset_pack_mesh *records = read_asset_pack(&game->frame, &pack, &mesh_count);
+   if(!records)
+   {
+      return;
+   }
+
+   // NOTE: Meshes are referred to by index, so adding, removing or reordering
+   // them still needs a restart.
+   bool compatible = (mesh_count == game->mesh_count);
+   for(int mesh_index = 0; compatible && mesh_index < mesh_count; ++mesh_index)
+   {
+      compatible = (strncmp(records[mesh_index].name, streamer->streams[mesh_index].record.name, ASSET_NAME_LENGTH) == 0);
+   }
+
+   if(!compatible)
+   {
+      platform_log("WARNING: The meshes in %s changed, restart to reload them.\n", ASSET_PACK_PATH);
+      platform_close_file(&pack);
+      return;
+   }
+
+   for(int mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+   {
+      if(!reserve_stream_jobs(&game->perma, streamer->streams + mesh_index, records + mesh_index))
+      {
+         platform_log("ERROR: Failed to allocate the asset streamer.\n");
+         platform_close_file(&pack);
+         return;
+      }
+   }
+
+   int changed_count = 0;
+   for(int mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+   {
+      // NOTE: Unchanged meshes may have only moved within the pack, and stay
+      // resident under their new record.
+      mesh_stream *stream = streamer->streams + mesh_index;
+      asset_pack_mesh previous = stream->record;
+      previous.data_offset = records[mesh_index].data_offset;
+
+      bool changed = (memcmp(&previous, records + mesh_index, sizeof(previous)) != 0);
+      if(changed)
+      {
+         if(stream->residency == MESHRESIDENCY_RESIDENT)
+         {
+            evict_mesh(game, mesh_index);
+         }
+
+         game->meshes[mesh_index].radius = records[mesh_index].radius;
+         stream->impostor_baked = false;
+         changed_count++;
+      }
+
+      stream->record = records[mesh_index];
+      stream->job_count = records[mesh_index].chunk_count;
+
+      // NOTE: The new pack may have fixed whatever failed to load.
+      if(stream->residency == MESHRESIDENCY_FAILED)
+      {
+         stream->residency = MESHRESIDENCY_UNLOADED;
+      }
+   }
+
+   platform_close_file(&streamer->pack);
+   streamer->pack = pack;
+
+   platform_log("Reloaded %d changed meshes from %s.\n", changed_count, ASSET_PACK_PATH);
+}
+
+static void update_streaming(game_context *game)
+{
+   asset_streamer *streamer = &game->streamer;
+   streamer->frame_index++;
+
+#if DEBUG
+   if(streamer->frame_index % STREAM_RELOAD_INTERVAL == 0)
+   {
+      reload_asset_pack(game);
+   }
+#endif
+
+   // NOTE: Pick up reads and loads that finished since the last frame.
+   platform_poll_reads();
+
+   for(int mesh_index = 0; mesh_index < game->mesh_count; ++mesh_index)
+   {
+      mesh_stream *stream = streamer->streams + mesh_index;
+      if(stream->residency == MESHRESIDENCY_READING)
+      {
+         u32 status = ATOMIC_LOAD(&stream->read.status);
+         if(status != PLATFORMREAD_PENDING)
+         {
+            streamer->reads_in_flight--;
+            if(status == PLATFORMREAD_FAILED)
+            {
+               fail_mesh_load(game, mesh_index, false);
+            }
+            else if(stream->record.chunk_count)
+            {
+               begin_mesh_decompression(game, mesh_index);
+            }
+            else
+            {
+               stream->residency = MESHRESIDENCY_LOADED;
+            }
+         }
+      }
+
+      if(ATOMIC_LOAD(&stream->residency) == MESHRESIDENCY_LOADED)
+      {
+         finish_mesh_load(game, mesh_index);
+      }
+   }
+
+   // NOTE: Find how close each mesh is to the camera.
+   for(int mesh_index = 0; mesh_index < game->mesh_count; ++mesh_index)
+   {
+      streamer->streams[mesh_index].distance = STREAM_DISTANCE;
+   }
+
+   for(int entity_index = 0; entity_index < countof(game->entities); ++entity_index)
+   {
+      entity *e = game->entities + entity_index;
+      if(e->active && e->mesh_index < game->mesh_count)
+      {
+         mesh_stream *stream = streamer->streams + e->mesh_index;
+         float distance = length(e->translation - game->camera_position) - game->meshes[e->mesh_index].radius;
+         if(distance < stream->distance)
+         {
+            stream->distance = distance;
+            stream->last_requested_frame = streamer->frame_index;
+         }
+      }
+   }
+
+   // NOTE: Start loads nearest first, while there is room for more reads and
+   // the work queue has room for their chunks.
+   for(;;)
+   {
+      int nearest = -1;
+      for(int mesh_index = 0; mesh_index < game->mesh_count; ++mesh_index)
+      {
+         mesh_stream *stream = streamer->streams + mesh_index;
+         if(stream->residency == MESHRESIDENCY_UNLOADED && stream->last_requested_frame == streamer->frame_index)
+         {
+            if(nearest < 0 || stream->distance < streamer->streams[nearest].distance)
+            {
+               nearest = mesh_index;
+            }
+         }
+      }
+
+      if(nearest < 0)
+      {
+         break;
+      }
+
+      // NOTE: A single mesh larger than the limit may still load when nothing
+      // else is in flight.
+      mesh_stream *stream = streamer->streams + nearest;
+      if(streamer->reads_in_flight >= STREAM_READ_COUNT_MAX)
+      {
+         break;
+      }
+
+      if(streamer->chunk_jobs_in_flight > 0 &&
+         streamer->chunk_jobs_in_flight + stream->job_count > STREAM_CHUNK_JOB_COUNT_MAX)
+      {
+         break;
+      }
+
+      if(!begin_mesh_load(game, nearest))
+      {
+         // NOTE: Nothing more fits this frame.
+         break;
+      }
+   }
 }
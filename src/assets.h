@@ -7,25 +7,304 @@
 // IMPORTANT: Mesh vertices are stored using a right-hand coordinate system,
 // where the positive x-direction is forward and positive z is up.
 
+// NOTE: The packer welds unique position/texcoord/normal combinations into a
+// single vertex buffer, so each face corner needs only one index.
+struct mesh_asset_vertex
+{
+   vec3 position;
+   vec2 texcoord;
+   vec3 normal;
+};
+
+// NOTE: Meshes may instead be packed with positions quantized to 16 bits
+// within the mesh bounds, texcoords quantized to 16 bits within the texcoord
+// bounds, and normals octahedral-encoded into two signed 16-bit values. This
+// cuts the vertex from 32 bytes to 14.
+enum mesh_vertex_format
+{
+   MESHVERTEX_FLOAT,
+   MESHVERTEX_PACKED,
+};
+
+struct mesh_asset_packed_vertex
+{
+   u16 position[3];
+   u16 texcoord[2];
+   s16 normal[2];
+};
+
 struct mesh_asset_face
 {
    int vertex_indices[3];
-   int texcoord_indices[3];
-   int normal_indices[3];
    u32 color;
+
+   // NOTE: Index into the mesh's textures, or -1 for untextured faces.
+   int texture_index;
 };
 
-struct mesh_asset
+// NOTE: Each level of detail is split into meshlets, small clusters of nearby
+// faces stored contiguously in the level's face list. The bounding sphere and
+// normal cone let whole clusters be culled before any per-face work.
+#define MESHLET_FACE_COUNT_MAX 64
+
+struct mesh_asset_meshlet
 {
+   int face_offset;
+   int face_count;
+
+   vec3 center;
+   float radius;
+
+   // NOTE: Every face normal lies within the cone around cone_axis whose
+   // half-angle has a sine of cone_cutoff. A cutoff of 1 disables cone culling.
+   vec3 cone_axis;
+   float cone_cutoff;
+};
+
+// NOTE: Each level of detail owns a contiguous range of the mesh's vertex
+// buffer, and its face indices are relative to the start of that range. Faces
+// are ordered for vertex cache reuse and vertices are ordered by first use. The
+// error is the object-space distance the simplified surface may deviate from
+// the original, which the renderer projects to pixels when choosing a level.
+#define MESH_LOD_COUNT_MAX 4
+
+struct mesh_asset_lod
+{
+   float error;
+
+   int vertex_offset;
    int vertex_count;
-   vec3 *vertices;
 
-   int texcoord_count;
-   vec2 *texcoords;
+   int face_count;
+   mesh_asset_face *faces;
 
-   int normal_count;
-   vec3 *normals;
+   int meshlet_count;
+   mesh_asset_meshlet *meshlets;
+};
+
+// NOTE: Diffuse textures are imported from the map_Kd entries of a mesh's
+// materials. Dimensions are powers of two, and each level of the mip chain is
+// box filtered from the one above it, down to a single texel. Texels are
+// 0xRRGGBBAA colors whose row 0 lies at v = 0, and each level is stored in
+// Morton order (see morton_index) so that texels close in both directions tend
+// to share a cache line.
+#define MESH_TEXTURE_COUNT_MAX 8
+#define TEXTURE_MIP_COUNT_MAX 13
+#define TEXTURE_SIZE_MAX (1 << (TEXTURE_MIP_COUNT_MAX - 1))
+
+struct mesh_asset_texture
+{
+   int width_log2;
+   int height_log2;
+
+   int mip_count;
+   u32 *mips[TEXTURE_MIP_COUNT_MAX];
+};
+
+struct mesh_asset
+{
+   mesh_vertex_format vertex_format;
+
+   int vertex_count;
+   union
+   {
+      mesh_asset_vertex *vertices;
+      mesh_asset_packed_vertex *packed_vertices;
+   };
+
+   // NOTE: Packed attributes decode as offset + quantized*scale.
+   vec3 position_offset;
+   vec3 position_scale;
+   vec2 texcoord_offset;
+   vec2 texcoord_scale;
 
    int face_count;
    mesh_asset_face *faces;
+
+   // NOTE: Bounding radius about the mesh origin.
+   float radius;
+
+   // NOTE: lods[0] always refers to the full-resolution faces above.
+   int lod_count;
+   mesh_asset_lod lods[MESH_LOD_COUNT_MAX];
+
+   int texture_count;
+   mesh_asset_texture textures[MESH_TEXTURE_COUNT_MAX];
+};
+
+// NOTE: The packer writes every mesh into a single binary pack file, which the
+// game streams blobs out of and uses in place. The file is laid out as a header,
+// a table of mesh records, then one aligned data blob per mesh. Offsets within
+// a mesh record are relative to the start of that mesh's blob, so each blob
+// can be moved around as a unit.
+#define ASSET_PACK_MAGIC 0x4D414542 // "BEAM"
+#define ASSET_PACK_VERSION 4
+#define ASSET_PACK_ALIGNMENT 64
+#define ASSET_NAME_LENGTH 32
+
+// NOTE: A blob may instead be stored LZ4-compressed in independent chunks of
+// ASSET_PACK_CHUNK_SIZE bytes (the last may be shorter), so the chunks can be
+// decompressed in parallel. The stored data begins with a table of chunk_count
+// entries. A chunk whose compressed size equals its size is stored as-is.
+#define ASSET_PACK_CHUNK_SIZE (64 * 1024)
+
+struct asset_pack_chunk
+{
+   u32 offset;
+   u32 compressed_size;
+};
+
+struct asset_pack_header
+{
+   u32 magic;
+   u32 version;
+   u32 mesh_count;
+   u32 mesh_table_offset;
+   u64 size;
+};
+
+struct asset_pack_lod
+{
+   u64 faces_offset;
+   u64 meshlets_offset;
+
+   float error;
+   u32 vertex_offset;
+   u32 vertex_count;
+   u32 face_count;
+   u32 meshlet_count;
+   u32 padding;
+};
+
+// NOTE: Mip levels are stored one after another from texels_offset.
+struct asset_pack_texture
+{
+   u64 texels_offset;
+
+   u32 width_log2;
+   u32 height_log2;
+   u32 mip_count;
+   u32 padding;
+};
+
+struct asset_pack_mesh
+{
+   char name[ASSET_NAME_LENGTH];
+
+   u64 data_offset;
+   u64 data_size;
+
+   // NOTE: For compressed blobs, data_offset and stored_size locate the chunk
+   // table and chunk data, and data_size is the decompressed size.
+   u64 stored_size;
+   u32 chunk_count;
+   u32 padding;
+
+   // NOTE: A hash of everything the mesh was packed from, so a reloaded pack
+   // shows which meshes changed.
+   u64 source_hash;
+
+   u64 vertices_offset;
+   u32 vertex_format;
+   u32 vertex_count;
+
+   float radius;
+   vec3 position_offset;
+   vec3 position_scale;
+   vec2 texcoord_offset;
+   vec2 texcoord_scale;
+
+   u32 lod_count;
+   asset_pack_lod lods[MESH_LOD_COUNT_MAX];
+
+   u32 texture_count;
+   u32 texture_padding;
+   asset_pack_texture textures[MESH_TEXTURE_COUNT_MAX];
+};
+
+// NOTE: Meshes are streamed from the pack into a fixed-size pool on demand.
+// Each frame the meshes used by entities within STREAM_DISTANCE of the camera
+// are requested nearest first, and the least recently requested meshes are
+// evicted whenever the pool runs out of room. Loads read a mesh blob with an
+// asynchronous platform read, then decompress it in chunk-sized jobs on the
+// platform work queue, so frames never wait on disk.
+#define STREAM_BUDGET_DEFAULT MEGABYTES(64)
+#define STREAM_DISTANCE 80.0f
+#define STREAM_READ_COUNT_MAX 16
+#define STREAM_CHUNK_JOB_COUNT_MAX 128
+
+// NOTE: Debug builds check the pack for changes this often, and swap in any
+// meshes the packer's watch mode has rebuilt.
+#define STREAM_RELOAD_INTERVAL 15
+
+// NOTE: A mesh whose load failed is not requested again until a reload swaps
+// in a new pack, so a bad pack is reported once rather than every frame.
+enum mesh_residency
+{
+   MESHRESIDENCY_UNLOADED,
+   MESHRESIDENCY_READING,
+   MESHRESIDENCY_DECOMPRESSING,
+   MESHRESIDENCY_LOADED,
+   MESHRESIDENCY_RESIDENT,
+   MESHRESIDENCY_FAILED,
+};
+
+struct mesh_stream;
+
+struct stream_chunk_job
+{
+   mesh_stream *stream;
+
+   u8 *source;
+   u32 compressed_size;
+
+   u8 *dest;
+   u32 size;
+};
+
+struct mesh_stream
+{
+   asset_pack_mesh record;
+
+   // NOTE: Workers only touch these three fields, and only while
+   // decompressing.
+   volatile u32 residency;
+   volatile u32 chunks_remaining;
+   volatile u32 failed;
+
+   int job_count;
+   int job_capacity;
+   stream_chunk_job *jobs;
+
+   platform_read read;
+
+   // NOTE: The mesh's range within the pool while loading or resident. A
+   // compressed blob is read into the end of the range and decompressed into
+   // the start, after which the range shrinks to the mesh itself.
+   u64 pool_offset;
+   u64 pool_size;
+
+   u64 last_requested_frame;
+   float distance;
+   bool impostor_baked;
+};
+
+struct asset_streamer
+{
+   platform_file pack;
+   u64 pack_time;
+
+   u8 *pool;
+   u64 pool_size;
+   u64 pool_used;
+
+   u64 frame_index;
+   int reads_in_flight;
+   int chunk_jobs_in_flight;
+
+   // NOTE: Indices of meshes holding pool memory, sorted by pool offset.
+   int allocation_count;
+   int *allocations;
+
+   mesh_stream *streams;
 };
@@ -0,0 +1,192 @@
+/* /////////////////////////////////////////////////////////////////////////// */
+/* (c) copyright 2024 Lawrence D. Kern /////////////////////////////////////// */
+/* /////////////////////////////////////////////////////////////////////////// */
+
+#include <string.h>
+
+// NOTE: A small implementation of the LZ4 block format, described at
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md. Each sequence is
+// a token byte (literal length in the high nibble, match length minus four in
+// the low nibble), optional length extension bytes, the literals, and a
+// two-byte little-endian match offset. The final sequence has literals only.
+
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MATCH_LIMIT 12
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_BITS 12
+
+// NOTE: The worst case output size, when nothing compresses.
+#define LZ4_COMPRESS_BOUND(size) ((size) + ((size) / 255) + 16)
+
+static u32 lz4_read32(u8 *at)
+{
+   u32 result;
+   memcpy(&result, at, sizeof(result));
+   return(result);
+}
+
+static u8 *lz4_write_length(u8 *out, u8 *out_end, int length)
+{
+   // NOTE: Lengths of 15 or more continue in bytes of 255 plus a remainder.
+   while(length >= 255)
+   {
+      if(out >= out_end) return(0);
+      *out++ = 255;
+      length -= 255;
+   }
+
+   if(out >= out_end) return(0);
+   *out++ = (u8)length;
+
+   return(out);
+}
+
+static u8 *lz4_write_sequence(u8 *out, u8 *out_end, u8 *literals, int literal_count, int offset, int match_length)
+{
+   u8 *token = out++;
+   if(token >= out_end) return(0);
+
+   int literal_code = MINIMUM(literal_count, 15);
+   *token = (u8)(literal_code << 4);
+   if(literal_code == 15)
+   {
+      out = lz4_write_length(out, out_end, literal_count - 15);
+      if(!out) return(0);
+   }
+
+   if(literal_count > out_end - out) return(0);
+   memcpy(out, literals, literal_count);
+   out += literal_count;
+
+   if(match_length > 0)
+   {
+      if(out_end - out < 2) return(0);
+      *out++ = (u8)(offset & 0xFF);
+      *out++ = (u8)(offset >> 8);
+
+      int match_code = MINIMUM(match_length - LZ4_MIN_MATCH, 15);
+      *token |= (u8)match_code;
+      if(match_code == 15)
+      {
+         out = lz4_write_length(out, out_end, match_length - LZ4_MIN_MATCH - 15);
+      }
+   }
+
+   return(out);
+}
+
+// NOTE: Greedy compression with a single-entry hash table. Returns the number
+// of bytes written, or 0 if the output did not fit.
+static int lz4_compress(u8 *source, int size, u8 *dest, int capacity)
+{
+   int table[1 << LZ4_HASH_BITS];
+   for(int index = 0; index < countof(table); ++index)
+   {
+      table[index] = -1;
+   }
+
+   u8 *out = dest;
+   u8 *out_end = dest + capacity;
+
+   int anchor = 0;
+   int position = 0;
+   int match_start_limit = size - LZ4_MATCH_LIMIT;
+   int match_end_limit = size - LZ4_LAST_LITERALS;
+
+   while(position < match_start_limit)
+   {
+      u32 sequence = lz4_read32(source + position);
+      u32 hash = (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+
+      int reference = table[hash];
+      table[hash] = position;
+
+      if(reference >= 0 && (position - reference) <= LZ4_MAX_OFFSET && lz4_read32(source + reference) == sequence)
+      {
+         int match_length = LZ4_MIN_MATCH;
+         while(position + match_length < match_end_limit && source[reference + match_length] == source[position + match_length])
+         {
+            match_length++;
+         }
+
+         out = lz4_write_sequence(out, out_end, source + anchor, position - anchor, position - reference, match_length);
+         if(!out) return(0);
+
+         position += match_length;
+         anchor = position;
+      }
+      else
+      {
+         position++;
+      }
+   }
+
+   out = lz4_write_sequence(out, out_end, source + anchor, size - anchor, 0, 0);
+   if(!out) return(0);
+
+   return((int)(out - dest));
+}
+
+// NOTE: Returns the number of bytes written, or -1 if the input is malformed
+// or would overflow the destination.
+static int lz4_decompress(u8 *source, int source_size, u8 *dest, int dest_size)
+{
+   u8 *in = source;
+   u8 *in_end = source + source_size;
+   u8 *out = dest;
+   u8 *out_end = dest + dest_size;
+
+   while(in < in_end)
+   {
+      int token = *in++;
+
+      int literal_count = token >> 4;
+      if(literal_count == 15)
+      {
+         int extension;
+         do
+         {
+            if(in >= in_end) return(-1);
+            extension = *in++;
+            literal_count += extension;
+         } while(extension == 255);
+      }
+
+      if(literal_count > in_end - in || literal_count > out_end - out) return(-1);
+      memcpy(out, in, literal_count);
+      in += literal_count;
+      out += literal_count;
+
+      // NOTE: The final sequence ends after its literals.
+      if(in >= in_end) break;
+
+      if(in_end - in < 2) return(-1);
+      int offset = in[0] | (in[1] << 8);
+      in += 2;
+
+      int match_length = (token & 15);
+      if(match_length == 15)
+      {
+         int extension;
+         do
+         {
+            if(in >= in_end) return(-1);
+            extension = *in++;
+            match_length += extension;
+         } while(extension == 255);
+      }
+      match_length += LZ4_MIN_MATCH;
+
+      if(offset == 0 || offset > out - dest || match_length > out_end - out) return(-1);
+
+      // NOTE: Matches may overlap their own output, so copy byte by byte.
+      u8 *match = out - offset;
+      for(int index = 0; index < match_length; ++index)
+      {
+         *out++ = *match++;
+      }
+   }
+
+   return((int)(out - dest));
+}
@@ -44,11 +44,32 @@ static void initialize_entities(game_context *game)
    }
 }
 
+// NOTE: Coarser levels of detail are used as long as their simplification
+// error stays under this many pixels on screen.
+#define LOD_ERROR_PIXELS 2.0f
+
+static int select_lod(mesh_asset *mesh, float pixels_per_unit)
+{
+   int result = 0;
+   for(int lod_index = 1; lod_index < mesh->lod_count; ++lod_index)
+   {
+      float error_pixels = mesh->lods[lod_index].error * pixels_per_unit;
+      if(error_pixels > LOD_ERROR_PIXELS)
+      {
+         break;
+      }
+      result = lod_index;
+   }
+
+   return(result);
+}
+
 static void update_entity(game_context *game, int entity_index, game_texture backbuffer)
 {
    entity *e = game->entities + entity_index;
    if(e->active)
    {
+      assert(e->mesh_index < game->mesh_count);
       mesh_asset mesh = game->meshes[e->mesh_index];
 
       mat4 scale = make_scale(e->scale.x, e->scale.y, e->scale.z);
@@ -57,48 +78,142 @@ static void update_entity(game_context *game, int entity_index, game_texture bac
       mat4 rotationz = make_rotationz(e->rotation.z);
       mat4 translation = make_translation(e->translation.x, e->translation.y, e->translation.z);
 
-      mat4 world = translation * scale * rotationx * rotationy * rotationz;
+      mat4 rotation = rotationx * rotationy * rotationz;
+      mat4 world = translation * scale * rotation;
 
-      for(int face_index = 0; face_index < mesh.face_count; ++face_index)
-      {
-         render_polygon polygon = make_polygon(&mesh, face_index);
-         // clip_polygon(&polygon);
+      // NOTE: Camera space uses +x as forward, so x is the view depth. The
+      // projection's x scale gives the number of pixels per unit at depth 1.
+      vec3 center = e->translation;
+      center *= game->view;
 
-         int clip_triangle_count = 0;
-         render_triangle clip_triangles[countof(polygon.vertices)];
-         triangles_from_polygon(&clip_triangle_count, clip_triangles, &polygon);
+      float depth = center.x;
+      float pixels_per_unit = 0.0f;
+      float entity_scale = MAXIMUM(MAXIMUM(e->scale.x, e->scale.y), e->scale.z);
+      if(depth > 0.0f)
+      {
+         pixels_per_unit = entity_scale * game->projection.e[0][0] * (backbuffer.width / 2.0f) / depth;
+      }
 
-         for(int clip_triangle_index = 0; clip_triangle_index < clip_triangle_count; ++clip_triangle_index)
+      float diameter = 2.0f * mesh.radius * pixels_per_unit;
+      if(sphere_outside_frustum(center, mesh.radius * entity_scale))
+      {
+         // NOTE: The entity's bounding sphere is out of view, so there is
+         // nothing to draw.
+      }
+      else if(depth > 0.0f && (diameter <= IMPOSTOR_SIZE || !mesh_is_resident(game, e->mesh_index)))
+      {
+         // NOTE: Entities that cover no more of the screen than an impostor
+         // cell are drawn as a single pre-rendered sprite. Meshes that are
+         // still streaming in fall back to their impostor at any size, or to
+         // the placeholder if they've never been loaded.
+         vec3 direction = transpose(rotation) * (e->translation - game->camera_position);
+         vec3 screen = project_to_screen(game->projection, center, backbuffer);
+
+         render_sprite sprite;
+         sprite.cell_index = get_placeholder_cell_index(game);
+         if(game->streamer.streams[e->mesh_index].impostor_baked)
          {
-            render_triangle *clipped_triangle = clip_triangles + clip_triangle_index;
-
-            assert(game->triangle_count < game->triangle_count_max);
-            int triangle_index = game->triangle_count++;
+            sprite.cell_index = e->mesh_index*IMPOSTOR_VIEW_COUNT + get_impostor_view(direction);
+         }
+         // NOTE: Up close the sprite's size and position grow without bound as
+         // the depth shrinks. Anything a few times larger than the backbuffer
+         // already covers it, so clamp before converting to pixels.
+         float limit = 4.0f * MAXIMUM(backbuffer.width, backbuffer.height);
+         float sprite_diameter = MINIMUM(diameter, limit);
+         float sprite_x = MAXIMUM(MINIMUM(screen.x, limit), -limit);
+         float sprite_y = MAXIMUM(MINIMUM(screen.y, limit), -limit);
+
+         sprite.size = MAXIMUM(round_to_int(sprite_diameter), 1);
+         sprite.x = (int)sprite_x - (sprite.size / 2);
+         sprite.y = (int)sprite_y - (sprite.size / 2);
+
+         push_sprite(game, sprite);
+      }
+      else if(mesh_is_resident(game, e->mesh_index))
+      {
+         mesh_asset_lod lod = mesh.lods[select_lod(&mesh, pixels_per_unit)];
+         // NOTE: Transform the level's vertices into camera space once.
+         vec3 *positions = arena_array(&game->frame, vec3, lod.vertex_count);
+         assert(positions);
 
-            render_triangle *triangle = game->triangles + triangle_index;
-            triangle->color = mesh.faces[face_index].color;
+         transform_vertices(positions, &mesh, lod.vertex_offset, lod.vertex_count, game->view * world);
 
-            for(int vertex_index = 0; vertex_index < 3; ++vertex_index)
-            {
-               // vec3 vertex = mesh.vertices[face.vertex_indices[vertex_index]];
-               vec3 vertex = clipped_triangle->vertices[vertex_index];
-               vertex *= world;
-               vertex *= game->view;
+         for(int meshlet_index = 0; meshlet_index < lod.meshlet_count; ++meshlet_index)
+         {
+            mesh_asset_meshlet *meshlet = lod.meshlets + meshlet_index;
 
-               // NOTE: Project into clip coordinates.
-               vertex = project(game->projection, vertex);
+            // NOTE: Cull clusters outside the frustum, then clusters whose faces
+            // all point away from the camera.
+            vec3 meshlet_center = meshlet->center;
+            meshlet_center *= world;
 
-               // NOTE: Convert to screen coordinates.
-               vertex.x *= (backbuffer.width / 2.0f);
-               vertex.y *= -(backbuffer.height / 2.0f);
+            float meshlet_radius = meshlet->radius * entity_scale;
 
-               vertex.x += (backbuffer.width / 2.0f);
-               vertex.y += (backbuffer.height / 2.0f);
+            vec3 view_center = meshlet_center;
+            view_center *= game->view;
+            if(sphere_outside_frustum(view_center, meshlet_radius))
+            {
+               continue;
+            }
 
-               triangle->vertices[vertex_index] = vertex;
+            if(meshlet->cone_cutoff < 1.0f)
+            {
+               vec3 axis = normalize(rotation * meshlet->cone_axis);
+               vec3 ray = meshlet_center - game->camera_position;
+               if(dot(ray, axis) >= meshlet->cone_cutoff*length(ray) + meshlet_radius)
+               {
+                  continue;
+               }
             }
 
-            push_triangle(game, triangle_index);
+            int face_end = meshlet->face_offset + meshlet->face_count;
+            for(int face_index = meshlet->face_offset; face_index < face_end; ++face_index)
+            {
+               mesh_asset_face face = lod.faces[face_index];
+               render_polygon polygon = make_polygon(&mesh, lod.vertex_offset, positions, face);
+               // clip_polygon(&polygon);
+
+               int clip_triangle_count = 0;
+               render_triangle clip_triangles[countof(polygon.vertices)];
+               triangles_from_polygon(&clip_triangle_count, clip_triangles, &polygon);
+
+               for(int clip_triangle_index = 0; clip_triangle_index < clip_triangle_count; ++clip_triangle_index)
+               {
+                  render_triangle *clipped_triangle = clip_triangles + clip_triangle_index;
+
+                  assert(game->triangle_count < game->triangle_count_max);
+                  int triangle_index = game->triangle_count++;
+
+                  render_triangle *triangle = game->triangles + triangle_index;
+                  triangle->color = face.color;
+                  triangle->texture = 0;
+                  triangle->filter = game->texture_filter_mode;
+                  if(face.texture_index >= 0)
+                  {
+                     triangle->texture = game->meshes[e->mesh_index].textures + face.texture_index;
+                  }
+
+                  for(int vertex_index = 0; vertex_index < 3; ++vertex_index)
+                  {
+                     vec3 vertex = clipped_triangle->vertices[vertex_index];
+                     triangle->vertices[vertex_index] = project_to_screen(game->projection, vertex, backbuffer);
+                     triangle->texcoords[vertex_index] = clipped_triangle->texcoords[vertex_index];
+
+                     // NOTE: Faces aren't clipped yet, so corners behind the
+                     // camera have no usable depth. Draw those flat.
+                     if(vertex.x > 0.0f)
+                     {
+                        triangle->inverse_depths[vertex_index] = 1.0f / vertex.x;
+                     }
+                     else
+                     {
+                        triangle->texture = 0;
+                     }
+                  }
+
+                  push_triangle(game, triangle_index);
+               }
+            }
          }
       }
    }
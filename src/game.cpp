@@ -8,9 +8,11 @@
 #include "memory.cpp"
 #include "math.cpp"
 #include "random.cpp"
-#include "assets.cpp"
+#include "compress.cpp"
 #include "render.cpp"
+#include "assets.cpp"
 #include "entity.cpp"
+#include "network.cpp"
 
 static bool is_held(game_button button)
 {
@@ -86,6 +88,14 @@ GAME_INITIALIZE(game_initialize)
       return;
    }
 
+   game->sprite_count_max = 1024 * 64;
+   game->sprites = arena_array(&game->perma, render_sprite, game->sprite_count_max);
+   if(!game->sprites)
+   {
+      platform_log("ERROR: Failed to allocate the sprite list.\n");
+      return;
+   }
+
    game->render_command_count_max = 1024 * 1024;
    game->render_commands = arena_array(&game->perma, render_command, game->render_command_count_max);
    if(!game->render_commands)
@@ -94,6 +104,11 @@ GAME_INITIALIZE(game_initialize)
       return;
    }
 
+   game->texture_filter_mode = TEXTUREFILTER_BILINEAR;
+
+   game->interpolation_delay_seconds = 3.0f / SERVER_TICK_RATE;
+   game->extrapolation_limit_seconds = 0.1f;
+
    float aspectx = (float)backbuffer->width / (float)backbuffer->height;
    float aspecty = (float)backbuffer->height / (float)backbuffer->width;
 
@@ -104,8 +119,19 @@ GAME_INITIALIZE(game_initialize)
    game->projection = make_perspective(aspectx, near, far);
    initialize_frustum_planes(aspectx, fov, near, far);
 
-   // NOTE: Load pre-bundled assets.
-   load_assets(game);
+   // NOTE: Open the asset pack produced by the packer. Mesh data is streamed
+   // in later, as entities come near the camera.
+   if(!load_assets(game, STREAM_BUDGET_DEFAULT))
+   {
+      return;
+   }
+
+   // NOTE: Impostors for drawing distant entities are rendered as each mesh
+   // is first streamed in.
+   if(!initialize_impostor_atlas(game))
+   {
+      return;
+   }
 
    // NOTE: Initialize entities.
    initialize_entities(game);
@@ -114,6 +140,231 @@ GAME_INITIALIZE(game_initialize)
    game->running = true;
 }
 
+static void update_tick_clock(game_context *game, u32 tick, u64 received_microseconds)
+{
+   // NOTE: Track the least delay seen between a tick and its snapshot
+   // arriving. Earlier arrivals move the estimate at once, and later ones only
+   // pull it up slowly, which follows drift between the clocks but not jitter.
+   s64 sample = (s64)received_microseconds - ((s64)tick * 1000000 / SERVER_TICK_RATE);
+   if(!game->has_tick_clock || sample < game->tick_clock_offset)
+   {
+      game->has_tick_clock = true;
+      game->tick_clock_offset = sample;
+   }
+   else
+   {
+      game->tick_clock_offset += (sample - game->tick_clock_offset) / 256;
+   }
+}
+
+static void reconcile_prediction(game_context *game, network_snapshot *snapshot)
+{
+   // NOTE: Compare the server's position for the local player with the one
+   // predicted for the same input. Any difference is added to the current
+   // position and to the predictions still in flight, the same as replaying
+   // those moves from where the server put the player.
+   int local_index = game->local_network_index;
+   u32 sequence = snapshot->input_sequence;
+   if(!sequence || !is_snapshot_player_present(snapshot, local_index) ||
+      game->input_sequence - sequence >= GAME_PREDICTION_HISTORY)
+   {
+      return;
+   }
+
+   vec3 predicted = game->predicted_positions[sequence % GAME_PREDICTION_HISTORY];
+   vec3 error = get_snapshot_player_position(snapshot, local_index) - predicted;
+
+   // NOTE: Differences within the quantization step are expected.
+   float tolerance = 1.0f / NETWORK_POSITION_SCALE;
+   if(absolute_value(error.x) > tolerance || absolute_value(error.y) > tolerance || absolute_value(error.z) > tolerance)
+   {
+      entity *player = game->entities + 0;
+      player->translation += error;
+
+      for(u32 index = sequence; index != game->input_sequence + 1; ++index)
+      {
+         game->predicted_positions[index % GAME_PREDICTION_HISTORY] += error;
+      }
+   }
+}
+
+static void receive_snapshots(game_context *game)
+{
+   // NOTE: Decode every snapshot the network thread has queued since the last
+   // update. Snapshots older than the newest one decoded arrived out of order,
+   // and are dropped.
+   bool received_newer = false;
+
+   int index;
+   while((index = begin_queue_pop(&game->snapshot_queue)) >= 0)
+   {
+      network_received_snapshot *received = game->received_snapshots + index;
+
+      network_snapshot snapshot;
+      int local_index;
+      if(read_snapshot(&snapshot, &local_index, received->data, received->size, game->snapshots) &&
+         snapshot.tick > game->latest_snapshot_tick)
+      {
+         game->snapshots[snapshot.tick % NETWORK_SNAPSHOT_HISTORY] = snapshot;
+         game->latest_snapshot_tick = snapshot.tick;
+         game->local_network_index = local_index;
+
+         update_tick_clock(game, snapshot.tick, received->received_microseconds);
+         received_newer = true;
+      }
+
+      end_queue_pop(&game->snapshot_queue);
+   }
+
+   if(received_newer)
+   {
+      reconcile_prediction(game, game->snapshots + (game->latest_snapshot_tick % NETWORK_SNAPSHOT_HISTORY));
+   }
+}
+
+static void find_opponent_samples(game_context *game, int index, u32 render_tick,
+                                  opponent_sample *from, opponent_sample *to, opponent_sample *previous)
+{
+   // NOTE: Find the player's samples either side of the render tick, and the
+   // one before that for extrapolating. Positions the server didn't refresh
+   // are repeated in later snapshots, which name the same sample tick.
+   *from = {};
+   *to = {};
+   *previous = {};
+
+   for(int history_index = 0; history_index < NETWORK_SNAPSHOT_HISTORY; ++history_index)
+   {
+      network_snapshot *test = game->snapshots + history_index;
+      if(!test->tick || game->latest_snapshot_tick - test->tick >= NETWORK_SNAPSHOT_HISTORY ||
+         !is_snapshot_player_present(test, index))
+      {
+         continue;
+      }
+
+      opponent_sample sample;
+      sample.valid = true;
+      sample.tick = test->tick - test->sample_ages[index];
+      sample.position = get_snapshot_player_position(test, index);
+
+      if(sample.tick <= render_tick)
+      {
+         if(!from->valid || sample.tick > from->tick)
+         {
+            if(from->valid)
+            {
+               *previous = *from;
+            }
+            *from = sample;
+         }
+         else if(sample.tick < from->tick && (!previous->valid || sample.tick > previous->tick))
+         {
+            *previous = sample;
+         }
+      }
+      else if(!to->valid || sample.tick < to->tick)
+      {
+         *to = sample;
+      }
+   }
+}
+
+static void update_opponents(game_context *game, u64 now_microseconds)
+{
+   if(!game->has_tick_clock)
+   {
+      return;
+   }
+
+   // NOTE: Place the render time on the server's timeline, as a whole tick
+   // and a fraction.
+   s64 delay = (s64)(game->interpolation_delay_seconds * 1000000.0f);
+   s64 render_microseconds = (s64)now_microseconds - game->tick_clock_offset - delay;
+   if(render_microseconds < 0)
+   {
+      return;
+   }
+
+   s64 scaled = render_microseconds * SERVER_TICK_RATE;
+   u32 render_tick = (u32)(scaled / 1000000);
+   float render_fraction = (float)(scaled % 1000000) / 1000000.0f;
+
+   // NOTE: Who is connected follows the newest snapshot at or before the
+   // render time, or the oldest one after it.
+   network_snapshot *from = 0;
+   network_snapshot *to = 0;
+   for(int history_index = 0; history_index < NETWORK_SNAPSHOT_HISTORY; ++history_index)
+   {
+      network_snapshot *test = game->snapshots + history_index;
+      if(!test->tick || game->latest_snapshot_tick - test->tick >= NETWORK_SNAPSHOT_HISTORY)
+      {
+         continue;
+      }
+
+      if(test->tick <= render_tick)
+      {
+         if(!from || test->tick > from->tick)
+         {
+            from = test;
+         }
+      }
+      else if(!to || test->tick < to->tick)
+      {
+         to = test;
+      }
+   }
+
+   network_snapshot *base = (from) ? from : to;
+   if(!base)
+   {
+      return;
+   }
+
+   float extrapolation_limit_ticks = game->extrapolation_limit_seconds * SERVER_TICK_RATE;
+
+   // NOTE: Opponent entities are indexed by network index, so players who
+   // leave disappear with them.
+   for(int index = 0; index < SERVERPLAYER_COUNT_MAX; ++index)
+   {
+      // TODO: Stop relying on hard-coded offsets to determine the type of
+      // entity we're looking at.
+      entity *opponent_entity = game->entities + GAMECONTROLLER_COUNT_MAX + index;
+      opponent_entity->active = (index != game->local_network_index && is_snapshot_player_present(base, index));
+      if(!opponent_entity->active)
+      {
+         continue;
+      }
+
+      opponent_sample from_sample;
+      opponent_sample to_sample;
+      opponent_sample previous_sample;
+      find_opponent_samples(game, index, render_tick, &from_sample, &to_sample, &previous_sample);
+
+      vec3 position = get_snapshot_player_position(base, index);
+      if(from_sample.valid)
+      {
+         float ticks_past_from = (float)(render_tick - from_sample.tick) + render_fraction;
+
+         position = from_sample.position;
+         if(to_sample.valid)
+         {
+            float t = ticks_past_from / (float)(to_sample.tick - from_sample.tick);
+            position = lerp(position, to_sample.position, t);
+         }
+         else if(previous_sample.valid)
+         {
+            vec3 velocity = (position - previous_sample.position) * (1.0f / (float)(from_sample.tick - previous_sample.tick));
+            position += velocity * MINIMUM(ticks_past_from, extrapolation_limit_ticks);
+         }
+      }
+      else if(to_sample.valid)
+      {
+         position = to_sample.position;
+      }
+
+      opponent_entity->translation = position;
+   }
+}
+
 GAME_UPDATE(game_update)
 {
    // NOTE: Set up the frame.
@@ -169,6 +420,12 @@ GAME_UPDATE(game_update)
          }
 
          if(was_pressed(con->start)) game->send_packet = !game->send_packet;
+
+         if(was_pressed(con->action_up))
+         {
+            bool bilinear = (game->texture_filter_mode == TEXTUREFILTER_BILINEAR);
+            game->texture_filter_mode = (bilinear) ? TEXTUREFILTER_NEAREST : TEXTUREFILTER_BILINEAR;
+         }
       }
    }
 
@@ -177,23 +434,17 @@ GAME_UPDATE(game_update)
 
    entity *player = game->entities + 0;
    vec3 camera_translation = player->translation + v3(-15, 0, 1);
+   game->camera_position = camera_translation;
    game->view = make_translation(-camera_translation.x, -camera_translation.y, -camera_translation.z);
 
+   // NOTE: Stream meshes in and out around the camera.
+   update_streaming(game);
+
    // NOTE: Update entities.
    if(game->send_packet)
    {
-      for(int index = 0; index < SERVERPLAYER_COUNT_MAX; ++index)
-      {
-         server_player *opponent = game->spacket.opponents + index;
-         if(opponent->client_id != game->client_id)
-         {
-            // TODO: Stop relying on hard-coded offsets to determine the type of
-            // entity we're looking at.
-            entity *opponent_entity = game->entities + GAMECONTROLLER_COUNT_MAX + index;
-            opponent_entity->active = true;
-            opponent_entity->translation = opponent->position;
-         }
-      }
+      receive_snapshots(game);
+      update_opponents(game, input->frame_microseconds);
    }
 
    for(int entity_index = 0; entity_index < countof(game->entities); ++entity_index)
@@ -218,11 +469,27 @@ GAME_UPDATE(game_update)
       }
    }
 
-   // NOTE: Store data to be delivered to server.
+   // NOTE: Queue data to be delivered to server. If the network thread has
+   // fallen behind, this frame's input is dropped like a lost packet.
    if(game->send_packet)
    {
-      game->packet.client_id = game->client_id;
-      game->packet.position = player->translation;
+      int index = begin_queue_push(&game->input_queue);
+      if(index >= 0)
+      {
+         u32 sequence = ++game->input_sequence;
+         game->predicted_positions[sequence % GAME_PREDICTION_HISTORY] = player->translation;
+
+         game_packet *packet = game->queued_inputs + index;
+         packet->client_id = game->client_id;
+         packet->input_sequence = sequence;
+         packet->position = player->translation;
+
+         // NOTE: The view only translates, so the camera always faces +x.
+         packet->view_direction = v3(1, 0, 0);
+         packet->acked_tick = game->latest_snapshot_tick;
+
+         end_queue_push(&game->input_queue);
+      }
    }
 }
 
@@ -239,9 +506,18 @@ GAME_RENDER(game_render)
             clear(backbuffer, command->color);
          } break;
 
-         case RENDERCOMMAND_TRIANGLE: {
-            assert(command->index < game->triangle_count);
-            draw_triangle(backbuffer, game->triangles[command->index]);
+         case RENDERCOMMAND_TRIANGLES: {
+            render_triangle_batch batch = command->batch;
+            assert(batch.triangle_index + batch.triangle_count <= game->triangle_count);
+            assert(batch.pipeline < RENDERPIPELINE_COUNT);
+
+            draw_triangle_batch_function *draw_batch = draw_triangle_batches[batch.pipeline];
+            draw_batch(backbuffer, game->triangles + batch.triangle_index, batch.triangle_count);
+         } break;
+
+         case RENDERCOMMAND_SPRITE: {
+            assert(command->index < game->sprite_count);
+            draw_sprite(backbuffer, game->impostor_atlas, game->sprites[command->index]);
          } break;
       }
    }
@@ -257,4 +533,5 @@ GAME_RENDER(game_render)
    // NOTE: Clear this frame's renderer state.
    game->render_command_count = 0;
    game->triangle_count = 0;
+   game->sprite_count = 0;
 }
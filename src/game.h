@@ -14,6 +14,10 @@
 #include "assets.h"
 #include "entity.h"
 #include "render.h"
+#include "network.h"
+
+#define GAME_PREDICTION_HISTORY 64
+static_assert((GAME_PREDICTION_HISTORY & (GAME_PREDICTION_HISTORY - 1)) == 0, "Prediction history must be a power of two.");
 
 #define GAME_TEXTURE_SIZE(t) (sizeof(*((t).memory)) * (t).width * (t).height)
 
@@ -76,26 +80,20 @@ struct game_controller
 struct game_input
 {
    float frame_seconds;
-   game_controller controllers[GAMECONTROLLER_COUNT_MAX];
-};
 
-struct game_packet
-{
-   u64 client_id;
-   vec3 position;
-};
+   // NOTE: The platform clock at the start of the frame, the same clock that
+   // stamps received snapshots.
+   u64 frame_microseconds;
 
-struct server_player
-{
-   u64 client_id;
-   vec3 position;
+   game_controller controllers[GAMECONTROLLER_COUNT_MAX];
 };
 
-#define SERVERPLAYER_COUNT_MAX 32
-struct server_packet
+// NOTE: One opponent's position as the server sampled it on the given tick.
+struct opponent_sample
 {
-   int opponent_count;
-   server_player opponents[SERVERPLAYER_COUNT_MAX - GAMECONTROLLER_COUNT_MAX];
+   bool valid;
+   u32 tick;
+   vec3 position;
 };
 
 struct game_context
@@ -115,19 +113,62 @@ struct game_context
    int triangle_count_max;
    render_triangle *triangles;
 
+   int sprite_count;
+   int sprite_count_max;
+   render_sprite *sprites;
+
    int render_command_count;
    int render_command_count_max;
    render_command *render_commands;
 
+   texture_filter texture_filter_mode;
+
+   vec3 camera_position;
    mat4 view;
    mat4 projection;
 
-   entity entities[256];
-   mesh_asset meshes[2];
+   // NOTE: One column of IMPOSTOR_VIEW_COUNT cells per mesh, followed by a
+   // single placeholder cell.
+   game_texture impostor_atlas;
+
+   entity entities[512];
+
+   // NOTE: Only meshes whose stream is resident have valid data. The radius
+   // of every mesh is always available.
+   asset_streamer streamer;
+   int mesh_count;
+   mesh_asset *meshes;
 
    bool send_packet;
-   game_packet packet;
-   server_packet spacket;
+
+   // NOTE: The platform's network thread pushes each snapshot as soon as it
+   // has been reassembled, and sends each packet pushed to the input queue.
+   // Both queues have the game on one end and the network thread on the other.
+   network_queue snapshot_queue;
+   network_received_snapshot received_snapshots[NETWORK_QUEUE_SIZE];
+   network_queue input_queue;
+   game_packet queued_inputs[NETWORK_QUEUE_SIZE];
+
+   int local_network_index;
+   u32 latest_snapshot_tick;
+   network_snapshot snapshots[NETWORK_SNAPSHOT_HISTORY];
+
+   // NOTE: Opponents are drawn interpolation_delay_seconds behind the server's
+   // timeline, so a late snapshot rarely leaves nothing to interpolate towards.
+   // Each opponent moves between its own samples, which for distant opponents
+   // are several ticks apart. Past its newest sample an opponent is
+   // extrapolated for at most extrapolation_limit_seconds, then held. The timeline is placed on the
+   // platform clock by tick_clock_offset, the time tick zero would have arrived.
+   float interpolation_delay_seconds;
+   float extrapolation_limit_seconds;
+   bool has_tick_clock;
+   s64 tick_clock_offset;
+
+   // NOTE: The local player moves as soon as input arrives. The position sent
+   // with each input is kept, indexed by sequence number, to compare against
+   // the server's answer.
+   u32 input_sequence;
+   vec3 predicted_positions[GAME_PREDICTION_HISTORY];
 
    bool running;
 };
@@ -0,0 +1,366 @@
+/* /////////////////////////////////////////////////////////////////////////// */
+/* (c) copyright 2024 Lawrence D. Kern /////////////////////////////////////// */
+/* /////////////////////////////////////////////////////////////////////////// */
+
+// NOTE: This file is the entry point to a headless load tester for the server.
+// It runs any number of bot clients from one thread, each with its own UDP
+// socket, so the server sees them as separate players. Every bot sends input at
+// the server's tick rate while driving around a circular track, and decodes
+// each snapshot it gets back the same way the game does, acknowledging them so
+// the server deltas against real baselines.
+//
+// Once a second it reports packet rates. At the end it reports the latency
+// between sending an input and receiving the first snapshot that applied it,
+// as percentiles over every sample from every bot. Tick times can only be
+// measured inside the server, which logs them itself.
+//
+// Usage: beam_loadtest [client count] [seconds] [server IPv4 address]
+
+#include "game.h"
+#include "platform.h"
+
+#include "math.cpp"
+#include "network.cpp"
+#include "platform_libc.cpp"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <time.h>
+
+#define LOADTEST_CLIENT_COUNT_DEFAULT 64
+#define LOADTEST_SECONDS_DEFAULT 10
+#define LOADTEST_EVENT_COUNT 256
+
+// NOTE: Bots are spread evenly around the track, all driving the same way, and
+// take this long per lap.
+#define LOADTEST_TRACK_RADIUS 256.0f
+#define LOADTEST_LAP_SECONDS 60.0f
+
+// NOTE: Inputs older than this when their snapshot arrives aren't measured.
+#define LOADTEST_INPUT_HISTORY 64
+#define LOADTEST_LATENCY_SAMPLE_COUNT_MAX (1 << 24)
+
+struct loadtest_client
+{
+   int socket_handle;
+   u64 client_id;
+   float track_phase;
+
+   u32 input_sequence;
+   u64 input_sent_microseconds[LOADTEST_INPUT_HISTORY];
+
+   u32 applied_input_sequence;
+   u32 latest_snapshot_tick;
+   network_snapshot snapshots[NETWORK_SNAPSHOT_HISTORY];
+
+   network_reassembly reassembly;
+   u8 reassembly_data[NETWORK_FRAGMENT_COUNT_MAX * NETWORK_FRAGMENT_PAYLOAD_SIZE];
+};
+
+struct loadtest_stats
+{
+   u64 packets_sent;
+   u64 datagrams_received;
+   u64 bytes_received;
+   u64 snapshots_decoded;
+   u64 snapshots_failed;
+};
+
+static volatile sig_atomic_t loadtest_running = 1;
+
+static void loadtest_handle_signal(int signal_number)
+{
+   loadtest_running = 0;
+}
+
+static u64 loadtest_get_microseconds(void)
+{
+   timespec time;
+   clock_gettime(CLOCK_MONOTONIC, &time);
+
+   u64 result = (u64)time.tv_sec*1000000 + (u64)time.tv_nsec/1000;
+   return(result);
+}
+
+static int loadtest_open_socket(sockaddr_in *server_address)
+{
+   // NOTE: Connecting lets the kernel drop datagrams from anyone but the
+   // server, and lets sends skip the address.
+   int result = socket(AF_INET, SOCK_DGRAM|SOCK_NONBLOCK|SOCK_CLOEXEC, 0);
+   if(result >= 0 && connect(result, (sockaddr *)server_address, sizeof(*server_address)) < 0)
+   {
+      close(result);
+      result = -1;
+   }
+
+   return(result);
+}
+
+static void loadtest_send_input(loadtest_client *client, float seconds, u64 now, loadtest_stats *stats)
+{
+   float turns = client->track_phase + seconds / LOADTEST_LAP_SECONDS;
+
+   u32 sequence = ++client->input_sequence;
+   client->input_sent_microseconds[sequence % LOADTEST_INPUT_HISTORY] = now;
+
+   game_packet packet = {};
+   packet.client_id = client->client_id;
+   packet.input_sequence = sequence;
+   packet.position = v3(LOADTEST_TRACK_RADIUS * cosine(turns), LOADTEST_TRACK_RADIUS * sine(turns), 0);
+   packet.view_direction = v3(-sine(turns), cosine(turns), 0);
+   packet.acked_tick = client->latest_snapshot_tick;
+
+   // NOTE: A full socket buffer drops the input, the same as a lost packet.
+   if(send(client->socket_handle, &packet, sizeof(packet), 0) == sizeof(packet))
+   {
+      stats->packets_sent++;
+   }
+}
+
+static void loadtest_receive(loadtest_client *client, u32 *latency_samples, int *latency_sample_count, loadtest_stats *stats)
+{
+   u8 data[SERVER_PACKET_SIZE];
+   while(1)
+   {
+      ssize_t size = recv(client->socket_handle, data, sizeof(data), 0);
+      if(size < 0)
+      {
+         if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNREFUSED)
+         {
+            platform_log("ERROR: Failed to receive datagram. %s\n", strerror(errno));
+         }
+         break;
+      }
+
+      stats->datagrams_received++;
+      stats->bytes_received += size;
+
+      if(!receive_fragment(&client->reassembly, data, (int)size))
+      {
+         continue;
+      }
+
+      network_snapshot snapshot;
+      int local_index;
+      if(!read_snapshot(&snapshot, &local_index, client->reassembly.data, client->reassembly.size, client->snapshots))
+      {
+         stats->snapshots_failed++;
+         continue;
+      }
+
+      stats->snapshots_decoded++;
+      if(snapshot.tick <= client->latest_snapshot_tick)
+      {
+         continue;
+      }
+
+      client->snapshots[snapshot.tick % NETWORK_SNAPSHOT_HISTORY] = snapshot;
+      client->latest_snapshot_tick = snapshot.tick;
+
+      // NOTE: Only the first snapshot to apply an input measures it.
+      u32 sequence = snapshot.input_sequence;
+      if((s32)(sequence - client->applied_input_sequence) > 0)
+      {
+         client->applied_input_sequence = sequence;
+         if(client->input_sequence - sequence < LOADTEST_INPUT_HISTORY && *latency_sample_count < LOADTEST_LATENCY_SAMPLE_COUNT_MAX)
+         {
+            u64 sent = client->input_sent_microseconds[sequence % LOADTEST_INPUT_HISTORY];
+            latency_samples[(*latency_sample_count)++] = (u32)(loadtest_get_microseconds() - sent);
+         }
+      }
+   }
+}
+
+static int compare_latency_samples(const void *a, const void *b)
+{
+   u32 first = *(u32 *)a;
+   u32 second = *(u32 *)b;
+
+   int result = (first > second) - (first < second);
+   return(result);
+}
+
+int main(int argument_count, char **arguments)
+{
+   int client_count = (argument_count > 1) ? atoi(arguments[1]) : LOADTEST_CLIENT_COUNT_DEFAULT;
+   int seconds = (argument_count > 2) ? atoi(arguments[2]) : LOADTEST_SECONDS_DEFAULT;
+   const char *host = (argument_count > 3) ? arguments[3] : "127.0.0.1";
+   if(client_count <= 0 || seconds <= 0)
+   {
+      platform_log("Usage: %s [client count] [seconds] [server IPv4 address]\n", arguments[0]);
+      return(1);
+   }
+
+   sockaddr_in server_address = {};
+   server_address.sin_family = AF_INET;
+   server_address.sin_port = htons(SERVER_PORT);
+   if(inet_pton(AF_INET, host, &server_address.sin_addr) != 1)
+   {
+      platform_log("ERROR: Invalid server address %s.\n", host);
+      return(1);
+   }
+
+   struct sigaction action = {};
+   action.sa_handler = loadtest_handle_signal;
+   sigaction(SIGINT, &action, 0);
+   sigaction(SIGTERM, &action, 0);
+
+   // NOTE: Every bot needs its own descriptor, so ask for as many as allowed.
+   rlimit limit;
+   if(getrlimit(RLIMIT_NOFILE, &limit) == 0)
+   {
+      limit.rlim_cur = limit.rlim_max;
+      setrlimit(RLIMIT_NOFILE, &limit);
+   }
+
+   loadtest_client *clients = (loadtest_client *)platform_allocate(client_count * sizeof(loadtest_client));
+   u32 *latency_samples = (u32 *)platform_allocate(LOADTEST_LATENCY_SAMPLE_COUNT_MAX * sizeof(u32));
+   int epoll_handle = epoll_create1(EPOLL_CLOEXEC);
+   int timer_handle = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK|TFD_CLOEXEC);
+   if(!clients || !latency_samples || epoll_handle < 0 || timer_handle < 0)
+   {
+      platform_log("ERROR: Failed to set up the load test. %s\n", strerror(errno));
+      return(1);
+   }
+
+   // NOTE: Client IDs only need to differ from each other and from real
+   // clients, so offset them from the clock.
+   u64 client_id_base = loadtest_get_microseconds() << 20;
+
+   for(int index = 0; index < client_count; ++index)
+   {
+      loadtest_client *client = clients + index;
+      client->socket_handle = loadtest_open_socket(&server_address);
+      client->client_id = client_id_base + index;
+      client->track_phase = (float)index / (float)client_count;
+      client->reassembly.data = client->reassembly_data;
+
+      epoll_event event = {};
+      event.events = EPOLLIN;
+      event.data.u32 = index;
+      if(client->socket_handle < 0 || epoll_ctl(epoll_handle, EPOLL_CTL_ADD, client->socket_handle, &event) < 0)
+      {
+         platform_log("ERROR: Failed to open socket for bot %d. %s\n", index, strerror(errno));
+         return(1);
+      }
+   }
+
+   // NOTE: The timer gets an index past every bot.
+   itimerspec interval = {};
+   interval.it_interval.tv_nsec = 1000000000 / SERVER_TICK_RATE;
+   interval.it_value = interval.it_interval;
+
+   epoll_event timer_event = {};
+   timer_event.events = EPOLLIN;
+   timer_event.data.u32 = client_count;
+   if(timerfd_settime(timer_handle, 0, &interval, 0) < 0 || epoll_ctl(epoll_handle, EPOLL_CTL_ADD, timer_handle, &timer_event) < 0)
+   {
+      platform_log("ERROR: Failed to start the input timer. %s\n", strerror(errno));
+      return(1);
+   }
+
+   platform_log("Running %d bots against %s:%d for %d seconds.\n", client_count, host, SERVER_PORT, seconds);
+
+   int latency_sample_count = 0;
+   loadtest_stats total = {};
+   loadtest_stats interval_stats = {};
+
+   u64 start = loadtest_get_microseconds();
+   u64 end = start + (u64)seconds*1000000;
+   u64 next_report = start + 1000000;
+
+   u64 now = start;
+   while(loadtest_running && now < end)
+   {
+      epoll_event events[LOADTEST_EVENT_COUNT];
+      int ready = epoll_wait(epoll_handle, events, countof(events), 100);
+      if(ready < 0 && errno != EINTR)
+      {
+         platform_log("ERROR: Failed to wait for datagrams. %s\n", strerror(errno));
+         break;
+      }
+
+      now = loadtest_get_microseconds();
+      for(int index = 0; index < ready; ++index)
+      {
+         u32 client_index = events[index].data.u32;
+         if(client_index == (u32)client_count)
+         {
+            u64 expirations;
+            if(read(timer_handle, &expirations, sizeof(expirations)) == sizeof(expirations))
+            {
+               float elapsed = (float)(now - start) / 1000000.0f;
+               for(int bot = 0; bot < client_count; ++bot)
+               {
+                  loadtest_send_input(clients + bot, elapsed, now, &interval_stats);
+               }
+            }
+         }
+         else
+         {
+            loadtest_receive(clients + client_index, latency_samples, &latency_sample_count, &interval_stats);
+         }
+      }
+
+      if(now >= next_report)
+      {
+         platform_log("%3llus: %llu packets/s out, %llu datagrams/s in (%llu KB/s), %llu snapshots/s decoded, %llu failed.\n",
+                      (now - start) / 1000000,
+                      interval_stats.packets_sent,
+                      interval_stats.datagrams_received,
+                      interval_stats.bytes_received / 1024,
+                      interval_stats.snapshots_decoded,
+                      interval_stats.snapshots_failed);
+
+         total.packets_sent += interval_stats.packets_sent;
+         total.datagrams_received += interval_stats.datagrams_received;
+         total.bytes_received += interval_stats.bytes_received;
+         total.snapshots_decoded += interval_stats.snapshots_decoded;
+         total.snapshots_failed += interval_stats.snapshots_failed;
+         interval_stats = {};
+
+         next_report += 1000000;
+      }
+   }
+
+   float elapsed_seconds = (float)(now - start) / 1000000.0f;
+   platform_log("Sent %llu packets and received %llu datagrams in %.1f seconds.\n",
+                total.packets_sent, total.datagrams_received, elapsed_seconds);
+
+   if(latency_sample_count > 0)
+   {
+      qsort(latency_samples, latency_sample_count, sizeof(*latency_samples), compare_latency_samples);
+
+      float percentiles[] = {50.0f, 90.0f, 99.0f, 99.9f};
+      for(int index = 0; index < countof(percentiles); ++index)
+      {
+         int sample = (int)(percentiles[index] / 100.0f * (latency_sample_count - 1));
+         platform_log("Input to snapshot latency p%g: %.3fms\n", percentiles[index], latency_samples[sample] / 1000.0f);
+      }
+      platform_log("Input to snapshot latency max: %.3fms over %d samples\n",
+                   latency_samples[latency_sample_count - 1] / 1000.0f, latency_sample_count);
+   }
+   else
+   {
+      platform_log("No snapshots applied any input. Is the server running?\n");
+   }
+
+   for(int index = 0; index < client_count; ++index)
+   {
+      close(clients[index].socket_handle);
+   }
+   close(timer_handle);
+   close(epoll_handle);
+
+   platform_deallocate(latency_samples);
+   platform_deallocate(clients);
+
+   return(0);
+}
@@ -4,10 +4,27 @@
 
 // NOTE: This is our half-baked asset packer. Provide it a list of obj file
 // names (without the .obj extensions) located in the data directory to generate
-// the source code file src/assets.cpp with asset data embedded.
+// the binary asset pack data/assets.pack (see assets.h for the layout). Pass
+// -packed before the names to emit quantized vertices instead of floats, and
+// -compress to store each mesh as LZ4-compressed chunks. Diffuse textures named
+// by map_Kd in a mesh's MTL file are imported from TGA images, given mip chains
+// and packed alongside the mesh. Meshes are packed in parallel, and unchanged
+// meshes are reused from build/pack_cache. With -watch the packer keeps running
+// after the first pack, and repacks whenever a mesh's sources change so a
+// running debug build can reload them.
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#   define PACKER_WATCH_SUPPORTED 1
+#   include <poll.h>
+#   include <sys/inotify.h>
+#else
+#   define PACKER_WATCH_SUPPORTED 0
+#endif
 
 #include "platform.h"
 #include "platform_libc.cpp"
@@ -16,27 +33,66 @@
 #include "memory.cpp"
 
 #include "math.h"
+#include "math.cpp"
+
+#include "assets.h"
+#include "compress.cpp"
 
 struct wavefront_mtl
 {
    char *name;
 
    vec3 diffuse;
-   char diffuse_hex[7];
+   u32 diffuse_color;
+
+   // NOTE: The map_Kd file name, relative to the data directory, and the mesh
+   // texture it was imported as.
+   char *diffuse_map;
+   int texture_index;
+};
+
+// NOTE: Materials are looked up by name through an open-addressed hash table
+// of indices into the material array.
+#define MATERIAL_COUNT_MAX 256
+#define MATERIAL_SLOT_COUNT (MATERIAL_COUNT_MAX * 2)
+
+struct wavefront_mtl_table
+{
+   int count;
+   wavefront_mtl materials[MATERIAL_COUNT_MAX];
+   int slots[MATERIAL_SLOT_COUNT];
 };
 
-static int gmaterial_count;
-static wavefront_mtl gmaterials[256];
+static u32 hash_name(char *name, int length)
+{
+   // NOTE: FNV-1a.
+   u32 result = 2166136261u;
+   for(int index = 0; index < length; ++index)
+   {
+      result ^= (u8)name[index];
+      result *= 16777619u;
+   }
+
+   return(result);
+}
 
-// TODO: This should be a hash table keyed on the name, if we ever care.
-static wavefront_mtl *get_material_by_name(char *name)
+static wavefront_mtl *get_material_by_name(wavefront_mtl_table *table, char *name, int length)
 {
    wavefront_mtl *result = 0;
-   for(int index = 0; index < gmaterial_count; ++index)
+
+   u32 mask = MATERIAL_SLOT_COUNT - 1;
+   for(u32 slot = hash_name(name, length) & mask;; slot = (slot + 1) & mask)
    {
-      if(strcmp(name, gmaterials[index].name) == 0)
+      int material_index = table->slots[slot];
+      if(material_index < 0)
+      {
+         break;
+      }
+
+      wavefront_mtl *material = table->materials + material_index;
+      if(strncmp(material->name, name, length) == 0 && material->name[length] == 0)
       {
-         result = gmaterials + index;
+         result = material;
          break;
       }
    }
@@ -44,198 +100,2450 @@ static wavefront_mtl *get_material_by_name(char *name)
    return(result);
 }
 
-static void output_obj_code(FILE *out, memarena arena, char *basename)
+static wavefront_mtl *add_material(wavefront_mtl_table *table, memarena *arena, char *name, int length)
 {
-   // NOTE: Reset material array.
-   gmaterial_count = 0;
+   wavefront_mtl *result = get_material_by_name(table, name, length);
+   if(!result && table->count < MATERIAL_COUNT_MAX)
+   {
+      int material_index = table->count++;
+      result = table->materials + material_index;
+      *result = {};
 
-   char path[256] = {};
+      result->name = (char *)arena_allocate(arena, length + 1);
+      memcpy(result->name, name, length);
+      result->name[length] = 0;
+      result->texture_index = -1;
 
-   // NOTE: Parse material file.
-   snprintf(path, sizeof(path), "./data/%s.mtl", basename);
+      u32 mask = MATERIAL_SLOT_COUNT - 1;
+      u32 slot = hash_name(name, length) & mask;
+      while(table->slots[slot] >= 0)
+      {
+         slot = (slot + 1) & mask;
+      }
+      table->slots[slot] = material_index;
+   }
 
-   FILE *file = fopen(path, "r");
-   if(file)
+   return(result);
+}
+
+// NOTE: A minimal tokenizer over a memory-mapped text file. Every function
+// leaves the cursor just past whatever it consumed and never reads beyond end.
+struct text_cursor
+{
+   char *at;
+   char *end;
+};
+
+static bool is_space(char c)
+{
+   return(c == ' ' || c == '\t' || c == '\r');
+}
+
+static bool is_digit(char c)
+{
+   return(c >= '0' && c <= '9');
+}
+
+static void skip_spaces(text_cursor *cursor)
+{
+   while(cursor->at < cursor->end && is_space(*cursor->at)) cursor->at++;
+}
+
+static void skip_line(text_cursor *cursor)
+{
+   char *newline = (char *)memchr(cursor->at, '\n', cursor->end - cursor->at);
+   cursor->at = (newline) ? (newline + 1) : cursor->end;
+}
+
+static bool at_line_end(text_cursor *cursor)
+{
+   skip_spaces(cursor);
+   return(cursor->at >= cursor->end || *cursor->at == '\n' || *cursor->at == '#');
+}
+
+static int parse_token(text_cursor *cursor, char **token)
+{
+   skip_spaces(cursor);
+
+   *token = cursor->at;
+   while(cursor->at < cursor->end && !is_space(*cursor->at) && *cursor->at != '\n') cursor->at++;
+
+   return((int)(cursor->at - *token));
+}
+
+static bool token_equals(char *token, int length, const char *keyword)
+{
+   return((int)strlen(keyword) == length && memcmp(token, keyword, length) == 0);
+}
+
+static int parse_int(text_cursor *cursor)
+{
+   skip_spaces(cursor);
+
+   bool negative = false;
+   if(cursor->at < cursor->end && (*cursor->at == '-' || *cursor->at == '+'))
    {
-      wavefront_mtl *material = 0;
+      negative = (*cursor->at++ == '-');
+   }
 
-      char line[256];
-      while(fgets(line, sizeof(line), file))
-      {
-         if(line[0] == 'n' &&
-            line[1] == 'e' &&
-            line[2] == 'w' &&
-            line[3] == 'm' &&
-            line[4] == 't' &&
-            line[5] == 'l' &&
-            line[6] == ' ')
-         {
-            // Material name.
-            material = gmaterials + gmaterial_count++;
+   int result = 0;
+   while(cursor->at < cursor->end && is_digit(*cursor->at))
+   {
+      result = result*10 + (*cursor->at++ - '0');
+   }
 
-            char string_buffer[128];
-            sscanf(line, "newmtl %s\n", string_buffer);
+   return(negative ? -result : result);
+}
 
-            memsize size = strlen(string_buffer) + 1;
-            material->name = (char *)arena_allocate(&arena, size);
-            memcpy(material->name, string_buffer, size);
-         }
-         else if(line[0] == 'K' && line[1] == 'd' && line[2] == ' ')
-         {
-            vec3 *color = &material->diffuse;
-            sscanf(line, "Kd %f %f %f\n", &color->r, &color->g, &color->b);
+static float parse_float(text_cursor *cursor)
+{
+   skip_spaces(cursor);
+
+   bool negative = false;
+   if(cursor->at < cursor->end && (*cursor->at == '-' || *cursor->at == '+'))
+   {
+      negative = (*cursor->at++ == '-');
+   }
+
+   // NOTE: Accumulate up to 19 significant digits as an integer mantissa, then
+   // apply the decimal exponent once at the end.
+   u64 mantissa = 0;
+   int digit_count = 0;
+   int exponent = 0;
+   while(cursor->at < cursor->end && is_digit(*cursor->at))
+   {
+      if(digit_count < 19)
+      {
+         mantissa = mantissa*10 + (*cursor->at - '0');
+         if(mantissa) digit_count++;
+      }
+      else
+      {
+         exponent++;
+      }
+      cursor->at++;
+   }
 
-            u8 r = (u8)(color->r * 255.0f);
-            u8 g = (u8)(color->g * 255.0f);
-            u8 b = (u8)(color->b * 255.0f);
-            snprintf(material->diffuse_hex, 7, "%02x%02x%02x", r, g, b);
+   if(cursor->at < cursor->end && *cursor->at == '.')
+   {
+      cursor->at++;
+      while(cursor->at < cursor->end && is_digit(*cursor->at))
+      {
+         if(digit_count < 19)
+         {
+            mantissa = mantissa*10 + (*cursor->at - '0');
+            if(mantissa) digit_count++;
+            exponent--;
          }
+         cursor->at++;
       }
+   }
 
-      fclose(file);
+   if(cursor->at < cursor->end && (*cursor->at == 'e' || *cursor->at == 'E'))
+   {
+      cursor->at++;
+      exponent += parse_int(cursor);
    }
 
-   // NOTE: Parse mesh file.
-   snprintf(path, sizeof(path), "./data/%s.obj", basename);
+   static const double powers[] = {
+      1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+      1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+   };
 
-   file = fopen(path, "r");
-   if(file)
+   double result = (double)mantissa;
+   while(exponent > 22) result *= 1e22, exponent -= 22;
+   while(exponent < -22) result /= 1e22, exponent += 22;
+   if(exponent >= 0) result *= powers[exponent];
+   else result /= powers[-exponent];
+
+   return((float)(negative ? -result : result));
+}
+
+static void parse_mtl(memarena *arena, char *basename, wavefront_mtl_table *table)
+{
+   table->count = 0;
+   for(int index = 0; index < MATERIAL_SLOT_COUNT; ++index)
+   {
+      table->slots[index] = -1;
+   }
+
+   char path[256] = {};
+   snprintf(path, sizeof(path), "./data/%s.mtl", basename);
+
+   memsize size = 0;
+   char *memory = (char *)platform_map_file(path, &size);
+   if(memory)
    {
-      char line[256];
+      text_cursor cursor = {memory, memory + size};
+      wavefront_mtl *material = 0;
 
-      // Vertices
-      fprintf(out, "vec3 %s_vertices[] = {\n", basename);
-      while(fgets(line, sizeof(line), file))
+      while(cursor.at < cursor.end)
       {
-         if(line[0] == 'v' && line[1] == ' ')
+         char *keyword;
+         int length = parse_token(&cursor, &keyword);
+
+         if(token_equals(keyword, length, "newmtl"))
          {
-            float x, y, z;
-            sscanf(line, "v %f %f %f\n", &x, &y, &z);
-            fprintf(out, "   {%ff, %ff, %ff},\n", x, y, z);
+            char *name;
+            int name_length = parse_token(&cursor, &name);
+            material = add_material(table, arena, name, name_length);
          }
-      }
-      fprintf(out, "};\n\n");
-      fseek(file, 0, SEEK_SET);
+         else if(material && token_equals(keyword, length, "Kd"))
+         {
+            vec3 *color = &material->diffuse;
+            color->r = parse_float(&cursor);
+            color->g = parse_float(&cursor);
+            color->b = parse_float(&cursor);
 
-      // Texcoords
-      fprintf(out, "vec2 %s_texcoords[] = {\n", basename);
-      while(fgets(line, sizeof(line), file))
-      {
-         if(line[0] == 'v' && line[1] == 't' && line[2] == ' ')
+            u32 r = (u8)(color->r * 255.0f);
+            u32 g = (u8)(color->g * 255.0f);
+            u32 b = (u8)(color->b * 255.0f);
+            material->diffuse_color = (r << 24) | (g << 16) | (b << 8) | 0xFF;
+         }
+         else if(material && token_equals(keyword, length, "map_Kd"))
          {
-            float x, y;
-            sscanf(line, "vt %f %f\n", &x, &y);
-            fprintf(out, "   {%ff, %ff},\n", x, y);
+            // NOTE: Options may precede the file name, which always comes last.
+            char *name = 0;
+            int name_length = 0;
+            while(!at_line_end(&cursor))
+            {
+               name_length = parse_token(&cursor, &name);
+            }
+
+            if(name_length)
+            {
+               material->diffuse_map = (char *)arena_allocate(arena, name_length + 1);
+               memcpy(material->diffuse_map, name, name_length);
+               material->diffuse_map[name_length] = 0;
+            }
          }
+
+         skip_line(&cursor);
       }
-      fprintf(out, "};\n\n");
-      fseek(file, 0, SEEK_SET);
 
-      // Normals
-      fprintf(out, "vec3 %s_normals[] = {\n", basename);
-      while(fgets(line, sizeof(line), file))
+      platform_unmap_file(memory, size);
+   }
+}
+
+struct wavefront_face
+{
+   int vertex_indices[3];
+   int texcoord_indices[3];
+   int normal_indices[3];
+   u32 color;
+   int texture_index;
+};
+
+struct wavefront_obj
+{
+   int vertex_count;
+   vec3 *vertices;
+
+   int texcoord_count;
+   vec2 *texcoords;
+
+   int normal_count;
+   vec3 *normals;
+
+   int face_count;
+   wavefront_face *faces;
+};
+
+// NOTE: Element counts aren't known until the whole file has been read, so
+// elements are appended to chained blocks and flattened into arrays at the end.
+#define ELEMENT_BLOCK_SIZE 4096
+
+struct element_block
+{
+   element_block *next;
+   int count;
+   u8 *elements;
+};
+
+struct element_list
+{
+   memsize element_size;
+   int count;
+   element_block *first;
+   element_block *last;
+};
+
+static void *push_element(memarena *arena, element_list *list)
+{
+   element_block *block = list->last;
+   if(!block || block->count == ELEMENT_BLOCK_SIZE)
+   {
+      block = arena_struct(arena, element_block);
+      assert(block);
+
+      block->next = 0;
+      block->count = 0;
+      block->elements = (u8 *)arena_allocate(arena, list->element_size * ELEMENT_BLOCK_SIZE);
+      assert(block->elements);
+
+      if(list->last) list->last->next = block;
+      else list->first = block;
+      list->last = block;
+   }
+
+   list->count++;
+   return(block->elements + list->element_size*block->count++);
+}
+
+static void *flatten_elements(memarena *arena, element_list *list)
+{
+   u8 *result = (u8 *)arena_allocate(arena, list->element_size * list->count);
+
+   u8 *at = result;
+   for(element_block *block = list->first; block; block = block->next)
+   {
+      memcpy(at, block->elements, list->element_size * block->count);
+      at += list->element_size * block->count;
+   }
+
+   return(result);
+}
+
+static int resolve_index(int index, int count)
+{
+   // NOTE: OBJ indices are 1-based, and negative indices count back from the
+   // most recent element. Missing indices resolve to -1.
+   int result = -1;
+   if(index > 0) result = index - 1;
+   else if(index < 0) result = count + index;
+
+   return(result);
+}
+
+static bool parse_index(text_cursor *cursor, int count, int *index)
+{
+   // NOTE: Fails unless the cursor is on an integer that resolves to one of
+   // the count elements parsed so far.
+   skip_spaces(cursor);
+   char *start = cursor->at;
+   int value = parse_int(cursor);
+   bool has_digits = (cursor->at > start && is_digit(cursor->at[-1]));
+
+   *index = resolve_index(value, count);
+   return(has_digits && *index >= 0 && *index < count);
+}
+
+static bool parse_corner(text_cursor *cursor, int counts[3], int corner[3])
+{
+   // NOTE: Corners are v, v/t, v//n or v/t/n, indexing the vertices, texcoords
+   // and normals. Omitted texcoords and normals are -1.
+   corner[1] = -1;
+   corner[2] = -1;
+
+   bool result = parse_index(cursor, counts[0], &corner[0]);
+   if(result && cursor->at < cursor->end && *cursor->at == '/')
+   {
+      cursor->at++;
+      if(cursor->at < cursor->end && *cursor->at != '/')
       {
-         if(line[0] == 'v' && line[1] == 'n' && line[2] == ' ')
-         {
-            float x, y, z;
-            sscanf(line, "vn %f %f %f\n", &x, &y, &z);
-            fprintf(out, "   {%ff, %ff, %ff},\n", x, y, z);
-         }
+         result = parse_index(cursor, counts[1], &corner[1]);
+      }
+      if(result && cursor->at < cursor->end && *cursor->at == '/')
+      {
+         cursor->at++;
+         result = parse_index(cursor, counts[2], &corner[2]);
       }
-      fprintf(out, "};\n\n");
-      fseek(file, 0, SEEK_SET);
+   }
+
+   return(result);
+}
+
+static wavefront_obj parse_obj(memarena *arena, char *basename, wavefront_mtl_table *materials)
+{
+   wavefront_obj result = {};
+
+   char path[256] = {};
+   snprintf(path, sizeof(path), "./data/%s.obj", basename);
 
-      // Faces
-      fprintf(out, "mesh_asset_face %s_faces[] = {\n", basename);
+   memsize size = 0;
+   char *memory = (char *)platform_map_file(path, &size);
+   if(memory)
+   {
+      // NOTE: Parse into block lists in a single pass over the file.
+      element_list vertices = {sizeof(vec3)};
+      element_list texcoords = {sizeof(vec2)};
+      element_list normals = {sizeof(vec3)};
+      element_list faces = {sizeof(wavefront_face)};
 
+      text_cursor cursor = {memory, memory + size};
       wavefront_mtl *current_material = 0;
-      while(fgets(line, sizeof(line), file))
+      int line_number = 1;
+
+      while(cursor.at < cursor.end)
       {
-         if(line[0] == 'u' &&
-            line[1] == 's' &&
-            line[2] == 'e' &&
-            line[3] == 'm' &&
-            line[4] == 't' &&
-            line[5] == 'l' &&
-            line[6] == ' ')
+         char *keyword;
+         int length = parse_token(&cursor, &keyword);
+
+         if(token_equals(keyword, length, "v"))
+         {
+            vec3 *v = (vec3 *)push_element(arena, &vertices);
+            v->x = parse_float(&cursor);
+            v->y = parse_float(&cursor);
+            v->z = parse_float(&cursor);
+         }
+         else if(token_equals(keyword, length, "vt"))
+         {
+            vec2 *t = (vec2 *)push_element(arena, &texcoords);
+            t->x = parse_float(&cursor);
+            t->y = parse_float(&cursor);
+         }
+         else if(token_equals(keyword, length, "vn"))
+         {
+            vec3 *n = (vec3 *)push_element(arena, &normals);
+            n->x = parse_float(&cursor);
+            n->y = parse_float(&cursor);
+            n->z = parse_float(&cursor);
+         }
+         else if(token_equals(keyword, length, "usemtl"))
          {
-            char name[128];
-            sscanf(line, "usemtl %s\n", name);
-            current_material = get_material_by_name(name);
+            char *name;
+            int name_length = parse_token(&cursor, &name);
+            current_material = get_material_by_name(materials, name, name_length);
          }
-         else if(line[0] == 'f' && line[1] == ' ')
+         else if(token_equals(keyword, length, "f"))
          {
-            int v0, t0, n0;
-            int v1, t1, n1;
-            int v2, t2, n2;
-            sscanf(line, "f %d/%d/%d %d/%d/%d %d/%d/%d",
-                   &v0, &t0, &n0,
-                   &v1, &t1, &n1,
-                   &v2, &t2, &n2);
+            // NOTE: Polygons with more than three corners are triangulated as
+            // a fan around the first corner.
+            int corner_count = 0;
+            int corners[3][3];
+            u32 color = (current_material) ? current_material->diffuse_color : 0x555555FF;
+            int texture_index = (current_material) ? current_material->texture_index : -1;
+
+            // NOTE: Check every corner before emitting any triangles, so a bad
+            // corner drops the whole polygon rather than part of its fan.
+            int counts[3] = {vertices.count, texcoords.count, normals.count};
+            text_cursor check = cursor;
+            bool valid = true;
+            while(valid && !at_line_end(&check))
+            {
+               int corner[3];
+               valid = parse_corner(&check, counts, corner);
+            }
+
+            if(!valid)
+            {
+               platform_log("WARNING: %s.obj line %d: Ignoring a face with a malformed or out of range index.\n", basename, line_number);
+            }
+
+            while(valid && !at_line_end(&cursor))
+            {
+               int corner[3];
+               parse_corner(&cursor, counts, corner);
+               int v = corner[0];
+               int t = corner[1];
+               int n = corner[2];
 
+               int slot = MINIMUM(corner_count, 2);
+               corners[slot][0] = v;
+               corners[slot][1] = t;
+               corners[slot][2] = n;
 
-            fprintf(out, "   {{%d, %d, %d}, {%d, %d, %d}, {%d, %d, %d}, 0x%.*sff},\n",
-                    v0 - 1, v1 - 1, v2 - 1,
-                    t0 - 1, t1 - 1, t2 - 1,
-                    n0 - 1, n1 - 1, n2 - 1,
-                    6, (current_material) ? current_material->diffuse_hex : "555555");
+               if(++corner_count >= 3)
+               {
+                  wavefront_face *face = (wavefront_face *)push_element(arena, &faces);
+                  for(int corner = 0; corner < 3; ++corner)
+                  {
+                     face->vertex_indices[corner] = corners[corner][0];
+                     face->texcoord_indices[corner] = corners[corner][1];
+                     face->normal_indices[corner] = corners[corner][2];
+                  }
+                  face->color = color;
+                  face->texture_index = texture_index;
+
+                  // NOTE: The last corner becomes the middle of the next fan
+                  // triangle.
+                  corners[1][0] = v;
+                  corners[1][1] = t;
+                  corners[1][2] = n;
+               }
+            }
          }
+
+         skip_line(&cursor);
+         line_number++;
       }
-      fprintf(out, "};\n\n");
-      fseek(file, 0, SEEK_SET);
 
-      fclose(file);
+      platform_unmap_file(memory, size);
+
+      result.vertex_count = vertices.count;
+      result.vertices = (vec3 *)flatten_elements(arena, &vertices);
+      result.texcoord_count = texcoords.count;
+      result.texcoords = (vec2 *)flatten_elements(arena, &texcoords);
+      result.normal_count = normals.count;
+      result.normals = (vec3 *)flatten_elements(arena, &normals);
+      result.face_count = faces.count;
+      result.faces = (wavefront_face *)flatten_elements(arena, &faces);
    }
+
+   return(result);
 }
 
-int main(int argument_count, char **arguments)
+////////////////////////////////////////////////////////////////////////////////
+
+// NOTE: Vertex-to-face adjacency stored in compressed rows: the faces touching
+// a vertex are faces[offsets[vertex]] through faces[offsets[vertex] + counts[vertex] - 1].
+
+struct face_adjacency
+{
+   int vertex_count;
+   int *offsets;
+   int *counts;
+   int *faces;
+};
+
+static face_adjacency allocate_face_adjacency(memarena *arena, int vertex_count, int face_count)
+{
+   face_adjacency result = {};
+   result.vertex_count = vertex_count;
+   result.offsets = arena_array(arena, int, vertex_count);
+   result.counts = arena_array(arena, int, vertex_count);
+   result.faces = arena_array(arena, int, face_count * 3);
+
+   return(result);
+}
+
+static void build_face_adjacency(face_adjacency *adjacency, wavefront_face *faces, int face_count)
 {
-   FILE *out = fopen("./src/assets.cpp", "w");
-   memarena arena = arena_new(MEGABYTES(256));
+   int vertex_count = adjacency->vertex_count;
 
-   fprintf(out, "/* /////////////////////////////////////////////////////////////////////////// */\n");
-   fprintf(out, "/* (c) copyright 2024 Lawrence D. Kern /////////////////////////////////////// */\n");
-   fprintf(out, "/* /////////////////////////////////////////////////////////////////////////// */\n");
-   fprintf(out, "\n");
+   memset(adjacency->counts, 0, sizeof(int) * vertex_count);
+   for(int face_index = 0; face_index < face_count; ++face_index)
+   {
+      for(int corner = 0; corner < 3; ++corner)
+      {
+         adjacency->counts[faces[face_index].vertex_indices[corner]]++;
+      }
+   }
 
-   // NOTE: Output enum of mesh IDs.
-   fprintf(out, "enum mesh_id\n");
-   fprintf(out, "{\n");
-   for(int index = 1; index < argument_count; ++index)
+   int offset = 0;
+   for(int vertex = 0; vertex < vertex_count; ++vertex)
    {
-      fprintf(out, "   MESHID_%s,\n", arguments[index]);
+      adjacency->offsets[vertex] = offset;
+      offset += adjacency->counts[vertex];
+      adjacency->counts[vertex] = 0;
    }
-   fprintf(out, "};\n\n");
 
-   // NOTE: Output mesh struct literals.
-   for(int index = 1; index < argument_count; ++index)
+   for(int face_index = 0; face_index < face_count; ++face_index)
    {
-      output_obj_code(out, arena, arguments[index]);
+      for(int corner = 0; corner < 3; ++corner)
+      {
+         int vertex = faces[face_index].vertex_indices[corner];
+         adjacency->faces[adjacency->offsets[vertex] + adjacency->counts[vertex]++] = face_index;
+      }
    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// NOTE: Mesh simplification uses greedy half-edge collapses ordered by quadric
+// error (Garland & Heckbert). Collapsing a vertex onto one of its neighbors
+// means every LOD indexes the original vertex, texcoord and normal arrays, so
+// the levels only add face lists to the asset.
+
+struct quadric
+{
+   float xx, xy, xz, xw;
+   float yy, yz, yw;
+   float zz, zw;
+   float ww;
+
+   float weight;
+};
+
+static void add_plane(quadric *q, vec3 normal, float distance, float weight)
+{
+   float a = normal.x;
+   float b = normal.y;
+   float c = normal.z;
+   float d = distance;
 
-   // NOTE: Output loading function.
-   fprintf(out, "static void load_assets(game_context *game)\n");
-   fprintf(out, "{\n");
-   for(int index = 1; index < argument_count; ++index)
+   q->xx += weight*a*a; q->xy += weight*a*b; q->xz += weight*a*c; q->xw += weight*a*d;
+   q->yy += weight*b*b; q->yz += weight*b*c; q->yw += weight*b*d;
+   q->zz += weight*c*c; q->zw += weight*c*d;
+   q->ww += weight*d*d;
+
+   q->weight += weight;
+}
+
+static void add_quadric(quadric *q, quadric *other)
+{
+   q->xx += other->xx; q->xy += other->xy; q->xz += other->xz; q->xw += other->xw;
+   q->yy += other->yy; q->yz += other->yz; q->yw += other->yw;
+   q->zz += other->zz; q->zw += other->zw;
+   q->ww += other->ww;
+
+   q->weight += other->weight;
+}
+
+static float quadric_error(quadric *q, vec3 p)
+{
+   float x = p.x;
+   float y = p.y;
+   float z = p.z;
+
+   float result =
+      q->xx*x*x + 2*q->xy*x*y + 2*q->xz*x*z + 2*q->xw*x +
+      q->yy*y*y + 2*q->yz*y*z + 2*q->yw*y +
+      q->zz*z*z + 2*q->zw*z +
+      q->ww;
+
+   // NOTE: Normalizing by the accumulated plane weight turns the sum into a
+   // mean squared distance, which stays comparable as quadrics are merged.
+   if(q->weight > 0.0f)
    {
-      if(index != 1) fprintf(out, "\n");
+      result /= q->weight;
+   }
+
+   return(MAXIMUM(result, 0.0f));
+}
+
+struct collapse_edge
+{
+   int from;
+   int to;
+   float cost;
+};
 
-      int entity_index = index - 1;
-      char *basename = arguments[index];
+static int compare_collapse_edges(const void *a, const void *b)
+{
+   float cost_a = ((collapse_edge *)a)->cost;
+   float cost_b = ((collapse_edge *)b)->cost;
+
+   int result = (cost_a < cost_b) ? -1 : (cost_a > cost_b) ? 1 : 0;
+   return(result);
+}
+
+struct mesh_simplifier
+{
+   wavefront_obj *obj;
+
+   int face_count;
+   wavefront_face *faces;
+
+   quadric *quadrics;
+   bool *border;
+   bool *seam;
+
+   // NOTE: The texcoord a collapsed vertex's corners take on, which is the
+   // target's texcoord in the collapsed vertex's chart.
+   int *collapse_texcoords;
+
+   // NOTE: Rebuilt at the start of each pass.
+   face_adjacency adjacency;
+
+   int *remap;
+   bool *locked;
+   collapse_edge *edges;
+
+   float error;
+};
+
+static vec3 face_normal(vec3 *vertices, int *indices)
+{
+   vec3 p0 = vertices[indices[0]];
+   vec3 p1 = vertices[indices[1]];
+   vec3 p2 = vertices[indices[2]];
+
+   vec3 result = cross(p1 - p0, p2 - p0);
+   return(result);
+}
+
+static bool face_contains(wavefront_face *face, int vertex)
+{
+   int *v = face->vertex_indices;
+   bool result = (v[0] == vertex || v[1] == vertex || v[2] == vertex);
+   return(result);
+}
+
+static int count_edge_faces(mesh_simplifier *s, int a, int b)
+{
+   int result = 0;
 
-      fprintf(out, "   assert(%d < countof(game->entities));\n", entity_index);
-      fprintf(out, "   game->meshes[%d].vertex_count   = countof(%s_vertices);\n", entity_index, basename);
-      fprintf(out, "   game->meshes[%d].vertices       = %s_vertices;\n", entity_index, basename);
-      fprintf(out, "   game->meshes[%d].texcoord_count = countof(%s_texcoords);\n", entity_index, basename);
-      fprintf(out, "   game->meshes[%d].texcoords      = %s_texcoords;\n", entity_index, basename);
-      fprintf(out, "   game->meshes[%d].normal_count   = countof(%s_normals);\n", entity_index, basename);
-      fprintf(out, "   game->meshes[%d].normals        = %s_normals;\n", entity_index, basename);
-      fprintf(out, "   game->meshes[%d].face_count     = countof(%s_faces);\n", entity_index, basename);
-      fprintf(out, "   game->meshes[%d].faces          = %s_faces;\n", entity_index, basename);
+   int *faces = s->adjacency.faces + s->adjacency.offsets[a];
+   for(int index = 0; index < s->adjacency.counts[a]; ++index)
+   {
+      if(face_contains(s->faces + faces[index], b))
+      {
+         result++;
+      }
    }
-   fprintf(out, "}\n");
 
-   fclose(out);
+   return(result);
+}
+
+static mesh_simplifier begin_simplification(memarena *arena, wavefront_obj *obj)
+{
+   mesh_simplifier result = {};
+   int vertex_count = obj->vertex_count;
+
+   result.obj = obj;
+   result.face_count = obj->face_count;
+   result.faces = arena_array(arena, wavefront_face, obj->face_count);
+   memcpy(result.faces, obj->faces, sizeof(wavefront_face) * obj->face_count);
+
+   result.quadrics = arena_array(arena, quadric, vertex_count);
+   result.border = arena_array(arena, bool, vertex_count);
+   result.seam = arena_array(arena, bool, vertex_count);
+   result.collapse_texcoords = arena_array(arena, int, vertex_count);
+   result.adjacency = allocate_face_adjacency(arena, vertex_count, obj->face_count);
+   result.remap = arena_array(arena, int, vertex_count);
+   result.locked = arena_array(arena, bool, vertex_count);
+   result.edges = arena_array(arena, collapse_edge, obj->face_count * 3);
+
+   memset(result.quadrics, 0, sizeof(quadric) * vertex_count);
+   memset(result.border, 0, sizeof(bool) * vertex_count);
+   memset(result.seam, 0, sizeof(bool) * vertex_count);
+
+   build_face_adjacency(&result.adjacency, result.faces, result.face_count);
+
+   // NOTE: A vertex whose corners use different texcoords lies on a UV seam,
+   // and its corners on either side belong to different charts. Seam vertices
+   // are never collapsed, which keeps the seams intact. Every other vertex
+   // lies in a single chart, so collapsing it can take the target's texcoord
+   // from any face on the collapsed edge.
+   int *first_texcoords = arena_array(arena, int, vertex_count);
+   for(int vertex = 0; vertex < vertex_count; ++vertex)
+   {
+      first_texcoords[vertex] = -2;
+   }
+   for(int face_index = 0; face_index < result.face_count; ++face_index)
+   {
+      wavefront_face *face = result.faces + face_index;
+      for(int corner = 0; corner < 3; ++corner)
+      {
+         int vertex = face->vertex_indices[corner];
+         int texcoord = face->texcoord_indices[corner];
+         if(first_texcoords[vertex] == -2)
+         {
+            first_texcoords[vertex] = texcoord;
+         }
+         else if(first_texcoords[vertex] != texcoord)
+         {
+            result.seam[vertex] = true;
+         }
+      }
+   }
+
+   // NOTE: Seed each vertex with the planes of its faces. Border edges also
+   // contribute a heavily weighted plane perpendicular to the face, which keeps
+   // open silhouettes from collapsing inward.
+   for(int face_index = 0; face_index < result.face_count; ++face_index)
+   {
+      wavefront_face *face = result.faces + face_index;
+      int *v = face->vertex_indices;
+
+      vec3 normal = face_normal(obj->vertices, v);
+      if(length(normal) > 0.0f)
+      {
+         normal = normalize(normal);
+         float distance = -dot(normal, obj->vertices[v[0]]);
+
+         for(int corner = 0; corner < 3; ++corner)
+         {
+            add_plane(result.quadrics + v[corner], normal, distance, 1.0f);
+
+            int a = v[corner];
+            int b = v[(corner + 1) % 3];
+            if(count_edge_faces(&result, a, b) == 1)
+            {
+               vec3 edge = obj->vertices[b] - obj->vertices[a];
+               vec3 border_normal = cross(edge, normal);
+               if(length(border_normal) > 0.0f)
+               {
+                  border_normal = normalize(border_normal);
+                  float border_distance = -dot(border_normal, obj->vertices[a]);
+
+                  add_plane(result.quadrics + a, border_normal, border_distance, 10.0f);
+                  add_plane(result.quadrics + b, border_normal, border_distance, 10.0f);
+               }
+
+               result.border[a] = true;
+               result.border[b] = true;
+            }
+         }
+      }
+   }
+
+   return(result);
+}
+
+static bool collapse_flips_faces(mesh_simplifier *s, int from, int to)
+{
+   bool result = false;
+
+   int *faces = s->adjacency.faces + s->adjacency.offsets[from];
+   for(int index = 0; index < s->adjacency.counts[from]; ++index)
+   {
+      wavefront_face *face = s->faces + faces[index];
+      if(!face_contains(face, to))
+      {
+         int moved[3];
+         for(int corner = 0; corner < 3; ++corner)
+         {
+            int vertex = face->vertex_indices[corner];
+            moved[corner] = (vertex == from) ? to : vertex;
+         }
+
+         vec3 before = face_normal(s->obj->vertices, face->vertex_indices);
+         vec3 after = face_normal(s->obj->vertices, moved);
+
+         // NOTE: Reject collapses that turn a face over or squash it flat.
+         float before_length = length(before);
+         float after_length = length(after);
+         if(after_length <= 1e-4f * before_length ||
+            dot(before, after) < 0.25f * before_length * after_length)
+         {
+            result = true;
+            break;
+         }
+      }
+   }
+
+   return(result);
+}
+
+static int find_collapse_texcoord(mesh_simplifier *s, int from, int to)
+{
+   int result = -1;
+
+   bool found = false;
+   int *faces = s->adjacency.faces + s->adjacency.offsets[from];
+   for(int index = 0; index < s->adjacency.counts[from] && !found; ++index)
+   {
+      wavefront_face *face = s->faces + faces[index];
+      for(int corner = 0; corner < 3; ++corner)
+      {
+         if(face->vertex_indices[corner] == to)
+         {
+            result = face->texcoord_indices[corner];
+            found = true;
+            break;
+         }
+      }
+   }
+
+   return(result);
+}
+
+static void simplify(mesh_simplifier *s, int target_face_count)
+{
+   vec3 *vertices = s->obj->vertices;
+   int vertex_count = s->obj->vertex_count;
+
+   while(s->face_count > target_face_count)
+   {
+      build_face_adjacency(&s->adjacency, s->faces, s->face_count);
+
+      // NOTE: Gather every edge in its cheaper legal direction. Border vertices
+      // may only slide along border edges, and seam vertices stay put.
+      int edge_count = 0;
+      for(int face_index = 0; face_index < s->face_count; ++face_index)
+      {
+         int *v = s->faces[face_index].vertex_indices;
+         for(int corner = 0; corner < 3; ++corner)
+         {
+            int a = v[corner];
+            int b = v[(corner + 1) % 3];
+            if(a < b)
+            {
+               bool border_edge = (count_edge_faces(s, a, b) == 1);
+
+               quadric q = s->quadrics[a];
+               add_quadric(&q, s->quadrics + b);
+
+               collapse_edge *edge = s->edges + edge_count;
+               edge->cost = 3.4e38f;
+
+               if(!s->seam[a] && (!s->border[a] || (s->border[b] && border_edge)))
+               {
+                  edge->from = a;
+                  edge->to = b;
+                  edge->cost = quadric_error(&q, vertices[b]);
+               }
+               if(!s->seam[b] && (!s->border[b] || (s->border[a] && border_edge)))
+               {
+                  float cost = quadric_error(&q, vertices[a]);
+                  if(cost < edge->cost)
+                  {
+                     edge->from = b;
+                     edge->to = a;
+                     edge->cost = cost;
+                  }
+               }
+
+               if(edge->cost < 3.4e38f)
+               {
+                  edge_count++;
+               }
+            }
+         }
+      }
+
+      qsort(s->edges, edge_count, sizeof(collapse_edge), compare_collapse_edges);
+
+      for(int vertex = 0; vertex < vertex_count; ++vertex)
+      {
+         s->remap[vertex] = vertex;
+         s->locked[vertex] = false;
+      }
+
+      // NOTE: Apply as many independent collapses as possible this pass. Any
+      // vertex touching a collapsed neighborhood is locked until the adjacency
+      // is rebuilt.
+      int collapse_count = 0;
+      int removed_count = 0;
+      for(int edge_index = 0; edge_index < edge_count; ++edge_index)
+      {
+         collapse_edge *edge = s->edges + edge_index;
+         if(s->locked[edge->from] || s->locked[edge->to])
+         {
+            continue;
+         }
+
+         if(removed_count >= (s->face_count - target_face_count))
+         {
+            break;
+         }
+
+         if(collapse_flips_faces(s, edge->from, edge->to))
+         {
+            continue;
+         }
+
+         s->remap[edge->from] = edge->to;
+         s->collapse_texcoords[edge->from] = find_collapse_texcoord(s, edge->from, edge->to);
+         add_quadric(s->quadrics + edge->to, s->quadrics + edge->from);
+         s->error = MAXIMUM(s->error, edge->cost);
+
+         removed_count += count_edge_faces(s, edge->from, edge->to);
+         collapse_count++;
+
+         int neighborhood[2] = {edge->from, edge->to};
+         for(int index = 0; index < 2; ++index)
+         {
+            int vertex = neighborhood[index];
+            int *faces = s->adjacency.faces + s->adjacency.offsets[vertex];
+            for(int face_index = 0; face_index < s->adjacency.counts[vertex]; ++face_index)
+            {
+               int *v = s->faces[faces[face_index]].vertex_indices;
+               s->locked[v[0]] = true;
+               s->locked[v[1]] = true;
+               s->locked[v[2]] = true;
+            }
+         }
+      }
+
+      if(collapse_count == 0)
+      {
+         break;
+      }
+
+      // NOTE: Rewrite faces through the remap and drop the ones that became
+      // degenerate.
+      int face_count = 0;
+      for(int face_index = 0; face_index < s->face_count; ++face_index)
+      {
+         wavefront_face face = s->faces[face_index];
+         for(int corner = 0; corner < 3; ++corner)
+         {
+            int vertex = face.vertex_indices[corner];
+            if(s->remap[vertex] != vertex)
+            {
+               face.vertex_indices[corner] = s->remap[vertex];
+               face.texcoord_indices[corner] = s->collapse_texcoords[vertex];
+            }
+         }
+
+         int *v = face.vertex_indices;
+         if(v[0] != v[1] && v[1] != v[2] && v[2] != v[0])
+         {
+            s->faces[face_count++] = face;
+         }
+      }
+      s->face_count = face_count;
+   }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// NOTE: Meshlets are grown greedily from a seed face, always taking the
+// adjacent face whose centroid lies closest to the cluster's centroid. Faces are
+// reordered so that each meshlet is a contiguous run of the face list.
+
+static int build_meshlets(memarena arena, vec3 *vertices, int vertex_count,
+                          wavefront_face *faces, int face_count, mesh_asset_meshlet *meshlets)
+{
+   int meshlet_count = 0;
+
+   face_adjacency adjacency = allocate_face_adjacency(&arena, vertex_count, face_count);
+   build_face_adjacency(&adjacency, faces, face_count);
+
+   vec3 *centroids = arena_array(&arena, vec3, face_count);
+   bool *used = arena_array(&arena, bool, face_count);
+   bool *queued = arena_array(&arena, bool, face_count);
+   int *candidates = arena_array(&arena, int, face_count);
+   wavefront_face *ordered = arena_array(&arena, wavefront_face, face_count);
+
+   for(int face_index = 0; face_index < face_count; ++face_index)
+   {
+      int *v = faces[face_index].vertex_indices;
+      centroids[face_index] = (vertices[v[0]] + vertices[v[1]] + vertices[v[2]]) / 3.0f;
+
+      used[face_index] = false;
+      queued[face_index] = false;
+   }
+
+   int ordered_count = 0;
+   for(int seed = 0; seed < face_count; ++seed)
+   {
+      if(used[seed])
+      {
+         continue;
+      }
+
+      mesh_asset_meshlet *meshlet = meshlets + meshlet_count++;
+      meshlet->face_offset = ordered_count;
+      meshlet->face_count = 0;
+
+      vec3 centroid_sum = v3(0, 0, 0);
+
+      int candidate_count = 0;
+      candidates[candidate_count++] = seed;
+      queued[seed] = true;
+
+      while(meshlet->face_count < MESHLET_FACE_COUNT_MAX && candidate_count > 0)
+      {
+         vec3 centroid = centroid_sum / (float)MAXIMUM(meshlet->face_count, 1);
+
+         int best = 0;
+         float best_distance = 3.4e38f;
+         for(int index = 0; index < candidate_count; ++index)
+         {
+            float distance = length(centroids[candidates[index]] - centroid);
+            if(distance < best_distance)
+            {
+               best = index;
+               best_distance = distance;
+            }
+         }
+
+         int face_index = candidates[best];
+         candidates[best] = candidates[--candidate_count];
+         queued[face_index] = false;
+         used[face_index] = true;
+
+         ordered[ordered_count++] = faces[face_index];
+         meshlet->face_count++;
+         centroid_sum += centroids[face_index];
+
+         for(int corner = 0; corner < 3; ++corner)
+         {
+            int vertex = faces[face_index].vertex_indices[corner];
+            int *neighbors = adjacency.faces + adjacency.offsets[vertex];
+            for(int index = 0; index < adjacency.counts[vertex]; ++index)
+            {
+               int neighbor = neighbors[index];
+               if(!used[neighbor] && !queued[neighbor])
+               {
+                  candidates[candidate_count++] = neighbor;
+                  queued[neighbor] = true;
+               }
+            }
+         }
+      }
+
+      for(int index = 0; index < candidate_count; ++index)
+      {
+         queued[candidates[index]] = false;
+      }
+
+      // NOTE: Compute the bounding sphere about the center of the bounding box.
+      wavefront_face *meshlet_faces = ordered + meshlet->face_offset;
+
+      vec3 minimum = vertices[meshlet_faces[0].vertex_indices[0]];
+      vec3 maximum = minimum;
+      for(int index = 0; index < meshlet->face_count; ++index)
+      {
+         for(int corner = 0; corner < 3; ++corner)
+         {
+            vec3 p = vertices[meshlet_faces[index].vertex_indices[corner]];
+            minimum = v3(MINIMUM(minimum.x, p.x), MINIMUM(minimum.y, p.y), MINIMUM(minimum.z, p.z));
+            maximum = v3(MAXIMUM(maximum.x, p.x), MAXIMUM(maximum.y, p.y), MAXIMUM(maximum.z, p.z));
+         }
+      }
+
+      meshlet->center = (minimum + maximum) * 0.5f;
+      meshlet->radius = 0.0f;
+      for(int index = 0; index < meshlet->face_count; ++index)
+      {
+         for(int corner = 0; corner < 3; ++corner)
+         {
+            vec3 p = vertices[meshlet_faces[index].vertex_indices[corner]];
+            meshlet->radius = MAXIMUM(meshlet->radius, length(p - meshlet->center));
+         }
+      }
+
+      // NOTE: Compute the normal cone. Clusters whose normals spread across a
+      // hemisphere or more can never be back-facing as a whole.
+      vec3 normal_sum = v3(0, 0, 0);
+      for(int index = 0; index < meshlet->face_count; ++index)
+      {
+         vec3 normal = face_normal(vertices, meshlet_faces[index].vertex_indices);
+         if(length(normal) > 0.0f)
+         {
+            normal_sum += normalize(normal);
+         }
+      }
+
+      meshlet->cone_axis = v3(0, 0, 0);
+      meshlet->cone_cutoff = 1.0f;
+      if(length(normal_sum) > 0.0f)
+      {
+         vec3 axis = normalize(normal_sum);
+
+         float minimum_dot = 1.0f;
+         for(int index = 0; index < meshlet->face_count; ++index)
+         {
+            vec3 normal = face_normal(vertices, meshlet_faces[index].vertex_indices);
+            if(length(normal) > 0.0f)
+            {
+               minimum_dot = MINIMUM(minimum_dot, dot(axis, normalize(normal)));
+            }
+         }
+
+         if(minimum_dot > 0.0f)
+         {
+            meshlet->cone_axis = axis;
+            meshlet->cone_cutoff = square_root(1.0f - minimum_dot*minimum_dot);
+         }
+      }
+   }
+
+   memcpy(faces, ordered, sizeof(wavefront_face) * face_count);
+
+   return(meshlet_count);
+}
+
+// NOTE: After clustering, each level of detail is welded into its own
+// contiguous range of the mesh's vertex buffer. Faces within each meshlet are
+// reordered for post-transform cache reuse (Forsyth's linear-speed algorithm),
+// then vertices are renumbered in order of first use so that fetches walk the
+// vertex buffer sequentially.
+
+#define VERTEX_CACHE_SIZE 32
+
+static float get_vertex_cache_score(int cache_position, int remaining_valence)
+{
+   float result = -1.0f;
+   if(remaining_valence > 0)
+   {
+      result = 0.0f;
+      if(cache_position >= 0)
+      {
+         if(cache_position < 3)
+         {
+            // NOTE: Vertices of the triangle just emitted get a fixed score, so
+            // that strips are not unduly favored over fans.
+            result = 0.75f;
+         }
+         else
+         {
+            float scale = 1.0f / (VERTEX_CACHE_SIZE - 3);
+            result = powf(1.0f - (cache_position - 3)*scale, 1.5f);
+         }
+      }
+
+      // NOTE: Boost vertices with few faces left, to finish them off quickly.
+      result += 2.0f * powf((float)remaining_valence, -0.5f);
+   }
+
+   return(result);
+}
+
+static void optimize_vertex_cache(int *corners, int face_count, int *cache_positions, int *valences, bool *emitted, int *order)
+{
+   // NOTE: cache_positions and valences are indexed by vertex. They must be -1
+   // and 0 respectively on entry, and are restored before returning.
+   for(int corner = 0; corner < face_count*3; ++corner)
+   {
+      valences[corners[corner]]++;
+   }
+
+   for(int face_index = 0; face_index < face_count; ++face_index)
+   {
+      emitted[face_index] = false;
+   }
+
+   int cache_count = 0;
+   int cache[VERTEX_CACHE_SIZE + 3];
+
+   for(int step = 0; step < face_count; ++step)
+   {
+      int best = 0;
+      float best_score = -3.4e38f;
+      for(int face_index = 0; face_index < face_count; ++face_index)
+      {
+         if(!emitted[face_index])
+         {
+            int *v = corners + face_index*3;
+            float score =
+               get_vertex_cache_score(cache_positions[v[0]], valences[v[0]]) +
+               get_vertex_cache_score(cache_positions[v[1]], valences[v[1]]) +
+               get_vertex_cache_score(cache_positions[v[2]], valences[v[2]]);
+
+            if(score > best_score)
+            {
+               best = face_index;
+               best_score = score;
+            }
+         }
+      }
+
+      order[step] = best;
+      emitted[best] = true;
+
+      // NOTE: Move the emitted face's vertices to the front of the LRU cache.
+      int *v = corners + best*3;
+      int next_cache_count = 0;
+      int next_cache[VERTEX_CACHE_SIZE + 3];
+      for(int corner = 0; corner < 3; ++corner)
+      {
+         valences[v[corner]]--;
+         next_cache[next_cache_count++] = v[corner];
+      }
+
+      for(int index = 0; index < cache_count; ++index)
+      {
+         int vertex = cache[index];
+         cache_positions[vertex] = -1;
+
+         if(vertex != v[0] && vertex != v[1] && vertex != v[2])
+         {
+            next_cache[next_cache_count++] = vertex;
+         }
+      }
+
+      cache_count = MINIMUM(next_cache_count, VERTEX_CACHE_SIZE);
+      for(int index = 0; index < cache_count; ++index)
+      {
+         cache[index] = next_cache[index];
+         cache_positions[cache[index]] = index;
+      }
+   }
+
+   for(int index = 0; index < cache_count; ++index)
+   {
+      cache_positions[cache[index]] = -1;
+   }
+}
+
+struct packed_lod
+{
+   float error;
+
+   int vertex_offset;
+   int vertex_count;
+
+   int face_count;
+   mesh_asset_face *faces;
+
+   int meshlet_count;
+   mesh_asset_meshlet *meshlets;
+};
+
+static packed_lod pack_lod(memarena *arena, wavefront_obj *obj, wavefront_face *faces, int face_count,
+                           mesh_asset_vertex *vertex_buffer, int *vertex_buffer_count)
+{
+   packed_lod result = {};
+   result.vertex_offset = *vertex_buffer_count;
+   result.face_count = face_count;
+   result.faces = arena_array(arena, mesh_asset_face, face_count);
+   result.meshlets = arena_array(arena, mesh_asset_meshlet, face_count);
+
+   // NOTE: Everything below is scratch.
+   memarena scratch = *arena;
+
+   result.meshlet_count = build_meshlets(scratch, obj->vertices, obj->vertex_count, faces, face_count, result.meshlets);
+
+   // NOTE: Weld unique (position, texcoord, normal) triples into temporary
+   // vertex ids with an open-addressed hash table.
+   int corner_count = face_count * 3;
+   int *corners = arena_array(&scratch, int, corner_count);
+   int *unique_corners = arena_array(&scratch, int, corner_count);
+   int unique_count = 0;
+
+   int table_size = 1;
+   while(table_size < corner_count*2) table_size *= 2;
+
+   int *table = arena_array(&scratch, int, table_size);
+   for(int index = 0; index < table_size; ++index)
+   {
+      table[index] = -1;
+   }
+
+   for(int corner = 0; corner < corner_count; ++corner)
+   {
+      wavefront_face *face = faces + corner/3;
+      int v = face->vertex_indices[corner % 3];
+      int t = face->texcoord_indices[corner % 3];
+      int n = face->normal_indices[corner % 3];
+
+      u32 hash = ((u32)v * 73856093u) ^ ((u32)t * 19349663u) ^ ((u32)n * 83492791u);
+      for(u32 slot = hash & (table_size - 1);; slot = (slot + 1) & (table_size - 1))
+      {
+         if(table[slot] < 0)
+         {
+            table[slot] = unique_count;
+            unique_corners[unique_count] = corner;
+            corners[corner] = unique_count++;
+            break;
+         }
+
+         wavefront_face *test_face = faces + unique_corners[table[slot]]/3;
+         int test_corner = unique_corners[table[slot]] % 3;
+         if(test_face->vertex_indices[test_corner] == v &&
+            test_face->texcoord_indices[test_corner] == t &&
+            test_face->normal_indices[test_corner] == n)
+         {
+            corners[corner] = table[slot];
+            break;
+         }
+      }
+   }
+
+   // NOTE: Reorder faces within each meshlet for the vertex cache.
+   int *cache_positions = arena_array(&scratch, int, unique_count);
+   int *valences = arena_array(&scratch, int, unique_count);
+   for(int index = 0; index < unique_count; ++index)
+   {
+      cache_positions[index] = -1;
+      valences[index] = 0;
+   }
+
+   int *face_order = arena_array(&scratch, int, face_count);
+   bool *emitted = arena_array(&scratch, bool, MESHLET_FACE_COUNT_MAX);
+   for(int meshlet_index = 0; meshlet_index < result.meshlet_count; ++meshlet_index)
+   {
+      mesh_asset_meshlet *meshlet = result.meshlets + meshlet_index;
+      int offset = meshlet->face_offset;
+
+      optimize_vertex_cache(corners + offset*3, meshlet->face_count, cache_positions, valences, emitted, face_order + offset);
+      for(int index = 0; index < meshlet->face_count; ++index)
+      {
+         face_order[offset + index] += offset;
+      }
+   }
+
+   // NOTE: Renumber vertices by first use and append them to the vertex buffer.
+   int *final_indices = arena_array(&scratch, int, unique_count);
+   for(int index = 0; index < unique_count; ++index)
+   {
+      final_indices[index] = -1;
+   }
+
+   for(int face_index = 0; face_index < face_count; ++face_index)
+   {
+      int source_index = face_order[face_index];
+      wavefront_face *source = faces + source_index;
+      mesh_asset_face *face = result.faces + face_index;
+
+      for(int corner = 0; corner < 3; ++corner)
+      {
+         int unique = corners[source_index*3 + corner];
+         if(final_indices[unique] < 0)
+         {
+            final_indices[unique] = result.vertex_count++;
+
+            mesh_asset_vertex *vertex = vertex_buffer + (*vertex_buffer_count)++;
+            vertex->position = obj->vertices[source->vertex_indices[corner]];
+            // NOTE: Corners without a texcoord or normal get a zero texcoord
+            // and the face normal.
+            int texcoord_index = source->texcoord_indices[corner];
+            int normal_index = source->normal_indices[corner];
+            vertex->texcoord = (texcoord_index >= 0) ? obj->texcoords[texcoord_index] : v2(0, 0);
+            vertex->normal = (normal_index >= 0) ? obj->normals[normal_index] : normalize(face_normal(obj->vertices, source->vertex_indices));
+         }
+
+         face->vertex_indices[corner] = final_indices[unique];
+      }
+
+      face->color = source->color;
+      face->texture_index = source->texture_index;
+   }
+
+   return(result);
+}
+
+static u16 quantize_unorm16(float value, float offset, float scale)
+{
+   float result = (scale > 0.0f) ? ((value - offset) / scale) : 0.0f;
+   result = MINIMUM(MAXIMUM(result, 0.0f), 65535.0f);
+   return((u16)round_to_int(result));
+}
+
+static void encode_octahedral_normal(s16 *result, vec3 n)
+{
+   // NOTE: Project onto the octahedron |x| + |y| + |z| = 1, then fold the lower
+   // hemisphere over the diagonals so the whole sphere maps onto a square.
+   float sum = absolute_value(n.x) + absolute_value(n.y) + absolute_value(n.z);
+   float x = (sum > 0.0f) ? (n.x / sum) : 0.0f;
+   float y = (sum > 0.0f) ? (n.y / sum) : 0.0f;
+   if(n.z < 0.0f)
+   {
+      float folded_x = (1.0f - absolute_value(y)) * (x < 0.0f ? -1.0f : 1.0f);
+      float folded_y = (1.0f - absolute_value(x)) * (y < 0.0f ? -1.0f : 1.0f);
+      x = folded_x;
+      y = folded_y;
+   }
+
+   result[0] = (s16)round_to_int(x * 32767.0f);
+   result[1] = (s16)round_to_int(y * 32767.0f);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static u32 *load_tga(memarena *arena, char *path, int *width, int *height)
+{
+   // NOTE: Supports uncompressed and run-length encoded truecolor images with
+   // 24 or 32 bits per pixel, which covers what most tools export. Rows are
+   // returned bottom-up, so row 0 lies at v = 0.
+   u32 *result = 0;
+
+   memsize size = 0;
+   u8 *memory = (u8 *)platform_map_file(path, &size);
+   if(memory && size >= 18)
+   {
+      int id_length = memory[0];
+      int colormap_type = memory[1];
+      int image_type = memory[2];
+      int image_width = memory[12] | (memory[13] << 8);
+      int image_height = memory[14] | (memory[15] << 8);
+      int bits_per_pixel = memory[16];
+      bool top_down = (memory[17] & 0x20);
+
+      // NOTE: The size is reported even for images too large to be textures,
+      // which are turned away before anything is allocated.
+      *width = image_width;
+      *height = image_height;
+
+      bool run_length_encoded = (image_type == 10);
+      int bytes_per_pixel = bits_per_pixel / 8;
+
+      if(colormap_type == 0 && (image_type == 2 || image_type == 10) &&
+         (bits_per_pixel == 24 || bits_per_pixel == 32) &&
+         image_width > 0 && image_width <= TEXTURE_SIZE_MAX &&
+         image_height > 0 && image_height <= TEXTURE_SIZE_MAX)
+      {
+         int pixel_count = image_width * image_height;
+         result = arena_array(arena, u32, pixel_count);
+
+         u8 *at = memory + 18 + id_length;
+         u8 *end = memory + size;
+         int pixel = 0;
+         while(result && pixel < pixel_count)
+         {
+            // NOTE: Encoded images are a series of packets, each either a run
+            // of one repeated pixel or up to 128 literal pixels. Uncompressed
+            // images are read as one long literal packet.
+            int count = pixel_count;
+            bool repeat = false;
+            if(run_length_encoded)
+            {
+               if(at >= end)
+               {
+                  result = 0;
+                  break;
+               }
+
+               count = (*at & 0x7F) + 1;
+               repeat = (*at++ & 0x80);
+            }
+            count = MINIMUM(count, pixel_count - pixel);
+
+            for(int index = 0; index < count; ++index, ++pixel)
+            {
+               if(end - at < bytes_per_pixel)
+               {
+                  result = 0;
+                  break;
+               }
+
+               u32 b = at[0];
+               u32 g = at[1];
+               u32 r = at[2];
+               u32 a = (bytes_per_pixel == 4) ? at[3] : 0xFF;
+               if(!repeat || index == count - 1)
+               {
+                  at += bytes_per_pixel;
+               }
+
+               int x = pixel % image_width;
+               int y = pixel / image_width;
+               if(top_down)
+               {
+                  y = image_height - 1 - y;
+               }
+
+               result[y*image_width + x] = (r << 24) | (g << 16) | (b << 8) | a;
+            }
+         }
+      }
+   }
+
+   if(memory)
+   {
+      platform_unmap_file(memory, size);
+   }
+
+   return(result);
+}
+
+static int get_power_of_two_log2(int value)
+{
+   // NOTE: Returns -1 for values that aren't a power of two.
+   int result = 0;
+   while((1 << result) < value)
+   {
+      result++;
+   }
+
+   return(((1 << result) == value) ? result : -1);
+}
+
+struct packed_texture
+{
+   char *path;
+
+   int width_log2;
+   int height_log2;
+   int mip_count;
+
+   u64 texel_count;
+   u32 *texels;
+};
+
+static bool build_texture(memarena *arena, packed_texture *texture, u32 *image, int width, int height)
+{
+   int width_log2 = get_power_of_two_log2(width);
+   int height_log2 = get_power_of_two_log2(height);
+   if(width_log2 < 0 || height_log2 < 0 || width > TEXTURE_SIZE_MAX || height > TEXTURE_SIZE_MAX)
+   {
+      return(false);
+   }
+
+   texture->width_log2 = width_log2;
+   texture->height_log2 = height_log2;
+   texture->mip_count = MAXIMUM(width_log2, height_log2) + 1;
+
+   texture->texel_count = 0;
+   for(int mip_index = 0; mip_index < texture->mip_count; ++mip_index)
+   {
+      texture->texel_count += 1ull << (MAXIMUM(width_log2 - mip_index, 0) + MAXIMUM(height_log2 - mip_index, 0));
+   }
+
+   texture->texels = arena_array(arena, u32, texture->texel_count);
+   if(!texture->texels)
+   {
+      return(false);
+   }
+
+   u32 *level = image;
+   u32 *out = texture->texels;
+   for(int mip_index = 0; mip_index < texture->mip_count; ++mip_index)
+   {
+      int level_width_log2 = MAXIMUM(width_log2 - mip_index, 0);
+      int level_height_log2 = MAXIMUM(height_log2 - mip_index, 0);
+      int level_width = 1 << level_width_log2;
+      int level_height = 1 << level_height_log2;
+
+      for(int y = 0; y < level_height; ++y)
+      {
+         for(int x = 0; x < level_width; ++x)
+         {
+            out[morton_index(x, y, level_width_log2, level_height_log2)] = level[y*level_width + x];
+         }
+      }
+      out += level_width * level_height;
+
+      if(mip_index + 1 == texture->mip_count)
+      {
+         break;
+      }
+
+      // NOTE: Box filter the next level, averaging each channel over the 2x2
+      // block of texels it covers, or 2x1 once one side is down to a texel.
+      int next_width = MAXIMUM(level_width / 2, 1);
+      int next_height = MAXIMUM(level_height / 2, 1);
+      int step_x = level_width / next_width;
+      int step_y = level_height / next_height;
+      int sample_count = step_x * step_y;
+
+      u32 *next = arena_array(arena, u32, next_width * next_height);
+      if(!next)
+      {
+         return(false);
+      }
+
+      for(int y = 0; y < next_height; ++y)
+      {
+         for(int x = 0; x < next_width; ++x)
+         {
+            u32 sums[4] = {};
+            for(int sample_y = 0; sample_y < step_y; ++sample_y)
+            {
+               for(int sample_x = 0; sample_x < step_x; ++sample_x)
+               {
+                  u32 texel = level[(y*step_y + sample_y)*level_width + (x*step_x + sample_x)];
+                  for(int channel = 0; channel < 4; ++channel)
+                  {
+                     sums[channel] += (texel >> (24 - 8*channel)) & 0xFF;
+                  }
+               }
+            }
+
+            u32 texel = 0;
+            for(int channel = 0; channel < 4; ++channel)
+            {
+               texel |= ((sums[channel] + sample_count/2) / sample_count) << (24 - 8*channel);
+            }
+            next[y*next_width + x] = texel;
+         }
+      }
+
+      level = next;
+   }
+
+   return(true);
+}
+
+struct packed_mesh
+{
+   float radius;
+
+   mesh_vertex_format vertex_format;
+   int vertex_count;
+   mesh_asset_vertex *vertices;
+   mesh_asset_packed_vertex *packed_vertices;
+
+   vec3 position_offset;
+   vec3 position_scale;
+   vec2 texcoord_offset;
+   vec2 texcoord_scale;
+
+   int lod_count;
+   packed_lod lods[MESH_LOD_COUNT_MAX];
+
+   int texture_count;
+   packed_texture textures[MESH_TEXTURE_COUNT_MAX];
+};
+
+static void import_textures(memarena *arena, char *basename, wavefront_mtl_table *materials, packed_mesh *mesh)
+{
+   // NOTE: Materials that name the same map share a texture. A map that can't
+   // be imported leaves its faces untextured.
+   for(int material_index = 0; material_index < materials->count; ++material_index)
+   {
+      wavefront_mtl *material = materials->materials + material_index;
+      if(!material->diffuse_map)
+      {
+         continue;
+      }
+
+      for(int texture_index = 0; texture_index < mesh->texture_count; ++texture_index)
+      {
+         if(strcmp(mesh->textures[texture_index].path, material->diffuse_map) == 0)
+         {
+            material->texture_index = texture_index;
+            break;
+         }
+      }
+
+      if(material->texture_index >= 0)
+      {
+         continue;
+      }
+
+      if(mesh->texture_count == MESH_TEXTURE_COUNT_MAX)
+      {
+         platform_log("WARNING: %s: Ignoring %s, meshes may only use %d textures.\n", basename, material->diffuse_map, MESH_TEXTURE_COUNT_MAX);
+         continue;
+      }
+
+      char path[256] = {};
+      snprintf(path, sizeof(path), "./data/%s", material->diffuse_map);
+
+      int width = 0;
+      int height = 0;
+      u32 *image = load_tga(arena, path, &width, &height);
+      packed_texture *texture = mesh->textures + mesh->texture_count;
+      if(width > TEXTURE_SIZE_MAX || height > TEXTURE_SIZE_MAX)
+      {
+         platform_log("WARNING: %s: Ignoring %s, textures must be powers of two no larger than %d.\n", basename, path, TEXTURE_SIZE_MAX);
+      }
+      else if(!image)
+      {
+         platform_log("WARNING: %s: Failed to load %s, only TGA images are supported.\n", basename, path);
+      }
+      else if(!build_texture(arena, texture, image, width, height))
+      {
+         platform_log("WARNING: %s: Ignoring %s, textures must be powers of two no larger than %d.\n", basename, path, TEXTURE_SIZE_MAX);
+      }
+      else
+      {
+         texture->path = material->diffuse_map;
+         material->texture_index = mesh->texture_count++;
+      }
+   }
+}
+
+static packed_mesh pack_obj(memarena *arena, char *basename, bool packed)
+{
+   packed_mesh result = {};
+
+   wavefront_mtl_table *materials = arena_struct(arena, wavefront_mtl_table);
+   parse_mtl(arena, basename, materials);
+   import_textures(arena, basename, materials, &result);
+   wavefront_obj obj = parse_obj(arena, basename, materials);
+
+   for(int index = 0; index < obj.vertex_count; ++index)
+   {
+      result.radius = MAXIMUM(result.radius, length(obj.vertices[index]));
+   }
+
+   // NOTE: Each level of detail gets its own vertex range, so the buffer is
+   // sized for the worst case of three unique vertices per face per level.
+   mesh_asset_vertex *vertices = arena_array(arena, mesh_asset_vertex, obj.face_count * 3 * MESH_LOD_COUNT_MAX);
+   result.vertices = vertices;
+
+   result.lods[result.lod_count++] = pack_lod(arena, &obj, obj.faces, obj.face_count, vertices, &result.vertex_count);
+
+   // NOTE: Each level of detail targets half the faces of the previous one.
+   // Stop early once the mesh is too small to be worth reducing or the
+   // simplifier can no longer make meaningful progress.
+   mesh_simplifier simplifier = begin_simplification(arena, &obj);
+   while(result.lod_count < MESH_LOD_COUNT_MAX && simplifier.face_count >= 32)
+   {
+      int previous_face_count = simplifier.face_count;
+      simplify(&simplifier, previous_face_count / 2);
+      if(simplifier.face_count > (previous_face_count * 3) / 4)
+      {
+         break;
+      }
+
+      int lod_index = result.lod_count++;
+      packed_lod *lod = result.lods + lod_index;
+
+      *lod = pack_lod(arena, &obj, simplifier.faces, simplifier.face_count, vertices, &result.vertex_count);
+      lod->error = square_root(simplifier.error);
+
+      platform_log("%s: LOD %d has %d faces, %d vertices and %d meshlets (error %f).\n", basename, lod_index,
+                   lod->face_count, lod->vertex_count, lod->meshlet_count, lod->error);
+   }
+
+   result.vertex_format = MESHVERTEX_FLOAT;
+   if(packed)
+   {
+      // NOTE: Quantize against the bounds of the vertex buffer, so every level
+      // of detail shares the same decode parameters.
+      vec3 position_min = vertices[0].position;
+      vec3 position_max = vertices[0].position;
+      vec2 texcoord_min = vertices[0].texcoord;
+      vec2 texcoord_max = vertices[0].texcoord;
+      for(int index = 1; index < result.vertex_count; ++index)
+      {
+         vec3 p = vertices[index].position;
+         vec2 t = vertices[index].texcoord;
+
+         position_min = v3(MINIMUM(position_min.x, p.x), MINIMUM(position_min.y, p.y), MINIMUM(position_min.z, p.z));
+         position_max = v3(MAXIMUM(position_max.x, p.x), MAXIMUM(position_max.y, p.y), MAXIMUM(position_max.z, p.z));
+         texcoord_min = v2(MINIMUM(texcoord_min.u, t.u), MINIMUM(texcoord_min.v, t.v));
+         texcoord_max = v2(MAXIMUM(texcoord_max.u, t.u), MAXIMUM(texcoord_max.v, t.v));
+      }
+
+      result.vertex_format = MESHVERTEX_PACKED;
+      result.position_offset = position_min;
+      result.position_scale = (position_max - position_min) / 65535.0f;
+      result.texcoord_offset = texcoord_min;
+      result.texcoord_scale = (texcoord_max - texcoord_min) / 65535.0f;
+
+      result.packed_vertices = arena_array(arena, mesh_asset_packed_vertex, result.vertex_count);
+      for(int index = 0; index < result.vertex_count; ++index)
+      {
+         vec3 p = vertices[index].position;
+         vec2 t = vertices[index].texcoord;
+         vec3 o = result.position_offset;
+         vec3 s = result.position_scale;
+
+         mesh_asset_packed_vertex *vertex = result.packed_vertices + index;
+         vertex->position[0] = quantize_unorm16(p.x, o.x, s.x);
+         vertex->position[1] = quantize_unorm16(p.y, o.y, s.y);
+         vertex->position[2] = quantize_unorm16(p.z, o.z, s.z);
+         vertex->texcoord[0] = quantize_unorm16(t.u, result.texcoord_offset.u, result.texcoord_scale.u);
+         vertex->texcoord[1] = quantize_unorm16(t.v, result.texcoord_offset.v, result.texcoord_scale.v);
+         encode_octahedral_normal(vertex->normal, vertices[index].normal);
+      }
+   }
+
+   return(result);
+}
+
+struct pack_writer
+{
+   u8 *base;
+   u64 size;
+   u64 capacity;
+};
+
+static u64 pack_align(pack_writer *writer, u64 alignment)
+{
+   // NOTE: Padding bytes are left zeroed by the arena.
+   writer->size = (writer->size + alignment - 1) & ~(alignment - 1);
+   assert(writer->size <= writer->capacity);
+
+   return(writer->size);
+}
+
+static u64 pack_write(pack_writer *writer, void *data, u64 size)
+{
+   u64 result = pack_align(writer, 16);
+
+   assert(size <= writer->capacity - writer->size);
+   memcpy(writer->base + writer->size, data, size);
+   writer->size += size;
+
+   return(result);
+}
+
+static u64 get_mesh_blob_size(packed_mesh *mesh)
+{
+   // NOTE: Every array may need up to 15 bytes of alignment padding.
+   memsize vertex_size = (mesh->vertex_format == MESHVERTEX_PACKED) ? sizeof(mesh_asset_packed_vertex) : sizeof(mesh_asset_vertex);
+   u64 result = mesh->vertex_count*vertex_size + 16;
+   for(int lod_index = 0; lod_index < mesh->lod_count; ++lod_index)
+   {
+      packed_lod *lod = mesh->lods + lod_index;
+      result += lod->face_count*sizeof(mesh_asset_face) + 16;
+      result += lod->meshlet_count*sizeof(mesh_asset_meshlet) + 16;
+   }
+
+   for(int texture_index = 0; texture_index < mesh->texture_count; ++texture_index)
+   {
+      result += mesh->textures[texture_index].texel_count*sizeof(u32) + 16;
+   }
+
+   return(result);
+}
+
+static void write_mesh(pack_writer *writer, asset_pack_mesh *record, packed_mesh *mesh)
+{
+   // NOTE: The writer starts at the blob, so offsets come out blob-relative.
+   assert(writer->size == 0);
+
+   if(mesh->vertex_format == MESHVERTEX_PACKED)
+   {
+      record->vertices_offset = pack_write(writer, mesh->packed_vertices, mesh->vertex_count * sizeof(mesh_asset_packed_vertex));
+   }
+   else
+   {
+      record->vertices_offset = pack_write(writer, mesh->vertices, mesh->vertex_count * sizeof(mesh_asset_vertex));
+   }
+
+   record->vertex_format = mesh->vertex_format;
+   record->vertex_count = mesh->vertex_count;
+   record->radius = mesh->radius;
+   record->position_offset = mesh->position_offset;
+   record->position_scale = mesh->position_scale;
+   record->texcoord_offset = mesh->texcoord_offset;
+   record->texcoord_scale = mesh->texcoord_scale;
+   record->lod_count = mesh->lod_count;
+
+   for(int lod_index = 0; lod_index < mesh->lod_count; ++lod_index)
+   {
+      packed_lod *source = mesh->lods + lod_index;
+      asset_pack_lod *lod = record->lods + lod_index;
+
+      lod->error = source->error;
+      lod->vertex_offset = source->vertex_offset;
+      lod->vertex_count = source->vertex_count;
+      lod->face_count = source->face_count;
+      lod->faces_offset = pack_write(writer, source->faces, source->face_count * sizeof(mesh_asset_face));
+      lod->meshlet_count = source->meshlet_count;
+      lod->meshlets_offset = pack_write(writer, source->meshlets, source->meshlet_count * sizeof(mesh_asset_meshlet));
+   }
+
+   record->texture_count = mesh->texture_count;
+   for(int texture_index = 0; texture_index < mesh->texture_count; ++texture_index)
+   {
+      packed_texture *source = mesh->textures + texture_index;
+      asset_pack_texture *texture = record->textures + texture_index;
+
+      texture->width_log2 = source->width_log2;
+      texture->height_log2 = source->height_log2;
+      texture->mip_count = source->mip_count;
+      texture->texels_offset = pack_write(writer, source->texels, source->texel_count * sizeof(u32));
+   }
+
+   record->data_size = writer->size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// NOTE: Each mesh is packed independently on the platform work queue. Packed
+// blobs are cached on disk under a hash of the source files and the packer
+// version, so unchanged meshes are copied from the cache instead of rebuilt.
+// Bump PACKER_VERSION whenever the packer's output changes.
+#define PACKER_VERSION 5
+#define PACK_CACHE_DIRECTORY "./build/pack_cache"
+#define PACK_CACHE_MAGIC 0x48434150 // "PACH"
+
+#define ASSET_PACK_OUTPUT_PATH "./data/assets.pack"
+#define ASSET_PACK_TEMPORARY_PATH "./data/assets.pack.tmp"
+#define PACKER_WATCH_SETTLE_MILLISECONDS 100
+
+struct pack_cache_header
+{
+   u32 magic;
+   u32 packer_version;
+   u64 hash;
+   asset_pack_mesh record;
+};
+
+struct pack_job
+{
+   char *basename;
+   bool packed;
+   bool compressed;
+
+   u64 hash;
+   bool cached;
+   bool failed;
+
+   // NOTE: The record's data_offset is filled in when the pack is assembled.
+   asset_pack_mesh record;
+   u8 *data;
+
+   // NOTE: The bytes written to the pack, which are either the blob itself or
+   // its chunk table and compressed chunks.
+   u8 *stored_data;
+};
+
+static u64 hash_bytes(u64 hash, void *data, memsize size)
+{
+   // NOTE: A simple multiply-xorshift hash that consumes eight bytes at a time.
+   u8 *at = (u8 *)data;
+   while(size >= 8)
+   {
+      u64 word;
+      memcpy(&word, at, 8);
+      hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+      hash ^= hash >> 32;
+
+      at += 8;
+      size -= 8;
+   }
+
+   u64 tail = 0;
+   memcpy(&tail, at, size);
+   hash = (hash ^ tail ^ ((u64)size << 56)) * 0x9E3779B97F4A7C15ull;
+   hash ^= hash >> 29;
+
+   return(hash);
+}
+
+static bool hash_path(u64 *hash, memsize *size, char *path)
+{
+   memsize file_size = 0;
+   void *memory = platform_map_file(path, &file_size);
+   if(memory)
+   {
+      *hash = hash_bytes(*hash, memory, file_size);
+      *size += file_size;
+      platform_unmap_file(memory, file_size);
+   }
+
+   return(memory != 0);
+}
+
+static bool hash_file(u64 *hash, memsize *size, char *basename, const char *extension)
+{
+   char path[256] = {};
+   snprintf(path, sizeof(path), "./data/%s.%s", basename, extension);
+
+   return(hash_path(hash, size, path));
+}
+
+static void hash_textures(u64 *hash, memsize *size, char *basename)
+{
+   // NOTE: Textures are named by the MTL file, so parse it to find them.
+   memarena arena = arena_new(MEGABYTES(1));
+   wavefront_mtl_table *materials = arena_struct(&arena, wavefront_mtl_table);
+   if(materials)
+   {
+      parse_mtl(&arena, basename, materials);
+      for(int material_index = 0; material_index < materials->count; ++material_index)
+      {
+         char *diffuse_map = materials->materials[material_index].diffuse_map;
+         if(diffuse_map)
+         {
+            char path[256] = {};
+            snprintf(path, sizeof(path), "./data/%s", diffuse_map);
+            hash_path(hash, size, path);
+         }
+      }
+   }
+
+   platform_deallocate(arena.base);
+}
+
+static void get_cache_path(char *buffer, int size, pack_job *job)
+{
+   snprintf(buffer, size, "%s/%s.mesh", PACK_CACHE_DIRECTORY, job->basename);
+}
+
+static bool load_cached_mesh(pack_job *job)
+{
+   bool result = false;
+
+   char path[256];
+   get_cache_path(path, sizeof(path), job);
+
+   FILE *file = fopen(path, "rb");
+   if(file)
+   {
+      pack_cache_header header;
+      if(fread(&header, sizeof(header), 1, file) == 1 &&
+         header.magic == PACK_CACHE_MAGIC &&
+         header.packer_version == PACKER_VERSION &&
+         header.hash == job->hash)
+      {
+         job->record = header.record;
+         job->data = (u8 *)platform_allocate(job->record.data_size);
+         if(job->data && fread(job->data, 1, job->record.data_size, file) == job->record.data_size)
+         {
+            result = true;
+         }
+         else if(job->data)
+         {
+            platform_deallocate(job->data);
+            job->data = 0;
+         }
+      }
+
+      fclose(file);
+   }
+
+   return(result);
+}
+
+static void save_cached_mesh(pack_job *job)
+{
+   char path[256];
+   get_cache_path(path, sizeof(path), job);
+
+   // NOTE: Write to a temporary file first, so an interrupted packer never
+   // leaves a truncated entry behind.
+   char temporary_path[272];
+   snprintf(temporary_path, sizeof(temporary_path), "%s.tmp", path);
+
+   FILE *file = fopen(temporary_path, "wb");
+   if(file)
+   {
+      pack_cache_header header = {};
+      header.magic = PACK_CACHE_MAGIC;
+      header.packer_version = PACKER_VERSION;
+      header.hash = job->hash;
+      header.record = job->record;
+
+      bool written = (fwrite(&header, sizeof(header), 1, file) == 1 &&
+                      fwrite(job->data, 1, job->record.data_size, file) == job->record.data_size);
+      fclose(file);
+
+      if(written) rename(temporary_path, path);
+      else remove(temporary_path);
+   }
+}
+
+static bool compress_mesh(pack_job *job)
+{
+   asset_pack_mesh *record = &job->record;
+   record->chunk_count = (u32)((record->data_size + ASSET_PACK_CHUNK_SIZE - 1) / ASSET_PACK_CHUNK_SIZE);
+
+   u64 table_size = record->chunk_count * sizeof(asset_pack_chunk);
+   u64 capacity = table_size + record->chunk_count*LZ4_COMPRESS_BOUND(ASSET_PACK_CHUNK_SIZE);
+   job->stored_data = (u8 *)platform_allocate(capacity);
+   if(!job->stored_data)
+   {
+      return(false);
+   }
+
+   asset_pack_chunk *chunks = (asset_pack_chunk *)job->stored_data;
+   u64 stored_size = table_size;
+   for(u32 chunk_index = 0; chunk_index < record->chunk_count; ++chunk_index)
+   {
+      u64 offset = (u64)chunk_index * ASSET_PACK_CHUNK_SIZE;
+      int size = (int)MINIMUM(record->data_size - offset, ASSET_PACK_CHUNK_SIZE);
+
+      // NOTE: Keep chunks that don't shrink uncompressed.
+      u8 *out = job->stored_data + stored_size;
+      int compressed_size = lz4_compress(job->data + offset, size, out, (int)(capacity - stored_size));
+      if(compressed_size <= 0 || compressed_size >= size)
+      {
+         memcpy(out, job->data + offset, size);
+         compressed_size = size;
+      }
+
+      chunks[chunk_index].offset = (u32)stored_size;
+      chunks[chunk_index].compressed_size = compressed_size;
+      stored_size += compressed_size;
+   }
+   record->stored_size = stored_size;
+
+   return(true);
+}
+
+static void build_mesh(pack_job *job, memsize source_size)
+{
+   // NOTE: Scratch memory grows with the source, since parsing, simplification
+   // and welding all allocate in proportion to it.
+   memarena arena = arena_new(MAXIMUM(MEGABYTES(256), 32 * source_size));
+   if(!arena.base)
+   {
+      job->failed = true;
+      return;
+   }
+
+   packed_mesh mesh = pack_obj(&arena, job->basename, job->packed);
+
+   pack_writer writer = {};
+   writer.capacity = get_mesh_blob_size(&mesh);
+   writer.base = (u8 *)platform_allocate(writer.capacity);
+   if(writer.base)
+   {
+      write_mesh(&writer, &job->record, &mesh);
+      job->data = writer.base;
+      save_cached_mesh(job);
+   }
+   else
+   {
+      job->failed = true;
+   }
+
+   platform_deallocate(arena.base);
+}
+
+static void pack_mesh_job(void *data)
+{
+   pack_job *job = (pack_job *)data;
+
+   // NOTE: The key covers every input that affects the output.
+   memsize source_size = 0;
+   job->hash = hash_bytes(PACKER_VERSION, &job->packed, sizeof(job->packed));
+   if(!hash_file(&job->hash, &source_size, job->basename, "obj"))
+   {
+      platform_log("ERROR: Failed to read ./data/%s.obj.\n", job->basename);
+      job->failed = true;
+      return;
+   }
+   hash_file(&job->hash, &source_size, job->basename, "mtl");
+   hash_textures(&job->hash, &source_size, job->basename);
+
+   // NOTE: The cache holds uncompressed blobs, so compression isn't part of
+   // the key.
+   if(load_cached_mesh(job))
+   {
+      job->cached = true;
+   }
+   else
+   {
+      build_mesh(job, source_size);
+   }
+
+   if(!job->failed)
+   {
+      job->record.source_hash = job->hash;
+      job->record.stored_size = job->record.data_size;
+      job->record.chunk_count = 0;
+      job->stored_data = job->data;
+
+      if(job->compressed && !compress_mesh(job))
+      {
+         job->failed = true;
+      }
+   }
+}
+
+static void release_pack_job(pack_job *job)
+{
+   if(job->stored_data && job->stored_data != job->data)
+   {
+      platform_deallocate(job->stored_data);
+   }
+   if(job->data)
+   {
+      platform_deallocate(job->data);
+   }
+
+   job->data = 0;
+   job->stored_data = 0;
+}
+
+static bool write_pack(pack_job *jobs, int mesh_count)
+{
+   // NOTE: Lay out the header and mesh table, then append each mesh's blob.
+   int cached_count = 0;
+   u64 capacity = sizeof(asset_pack_header) + 16 + mesh_count*sizeof(asset_pack_mesh);
+   for(int mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+   {
+      pack_job *job = jobs + mesh_index;
+      cached_count += job->cached;
+      capacity += ASSET_PACK_ALIGNMENT + job->record.stored_size;
+   }
+
+   pack_writer writer = {};
+   writer.capacity = capacity;
+   writer.base = (u8 *)platform_allocate(writer.capacity);
+   if(!writer.base)
+   {
+      platform_log("ERROR: Failed to allocate the asset pack.\n");
+      return(false);
+   }
+
+   asset_pack_header header = {};
+   header.magic = ASSET_PACK_MAGIC;
+   header.version = ASSET_PACK_VERSION;
+   header.mesh_count = mesh_count;
+   pack_write(&writer, &header, sizeof(header));
+
+   header.mesh_table_offset = (u32)pack_align(&writer, 16);
+   writer.size += mesh_count * sizeof(asset_pack_mesh);
+
+   for(int mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+   {
+      pack_job *job = jobs + mesh_index;
+      snprintf(job->record.name, sizeof(job->record.name), "%s", job->basename);
+
+      job->record.data_offset = pack_align(&writer, ASSET_PACK_ALIGNMENT);
+      memcpy(writer.base + writer.size, job->stored_data, job->record.stored_size);
+      writer.size += job->record.stored_size;
+
+      memcpy(writer.base + header.mesh_table_offset + mesh_index*sizeof(asset_pack_mesh), &job->record, sizeof(job->record));
+   }
+
+   header.size = writer.size;
+   memcpy(writer.base, &header, sizeof(header));
+
+   // NOTE: Replace the pack with a rename, so a running game never sees a
+   // partially written file.
+   FILE *out = fopen(ASSET_PACK_TEMPORARY_PATH, "wb");
+   bool result = (out && fwrite(writer.base, 1, writer.size, out) == writer.size);
+   if(out) fclose(out);
+
+   result = result && (rename(ASSET_PACK_TEMPORARY_PATH, ASSET_PACK_OUTPUT_PATH) == 0);
+   if(result)
+   {
+      platform_log("Packed %d meshes (%d from cache) into %llu bytes.\n", mesh_count, cached_count, (unsigned long long)writer.size);
+   }
+   else
+   {
+      platform_log("ERROR: Failed to write %s.\n", ASSET_PACK_OUTPUT_PATH);
+      remove(ASSET_PACK_TEMPORARY_PATH);
+   }
+
+   platform_deallocate(writer.base);
+
+   return(result);
+}
+
+#if PACKER_WATCH_SUPPORTED
+static int find_changed_mesh(pack_job *jobs, int mesh_count, char *filename)
+{
+   // NOTE: Only a mesh's own OBJ and MTL files feed into it.
+   char *extension = strrchr(filename, '.');
+   if(!extension || (strcmp(extension, ".obj") && strcmp(extension, ".mtl")))
+   {
+      return(-1);
+   }
+
+   int basename_length = (int)(extension - filename);
+   for(int mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+   {
+      char *basename = jobs[mesh_index].basename;
+      if((int)strlen(basename) == basename_length && strncmp(basename, filename, basename_length) == 0)
+      {
+         return(mesh_index);
+      }
+   }
+
+   return(-1);
+}
+
+static void watch_assets(pack_job *jobs, int mesh_count)
+{
+   // NOTE: Keep every packed mesh in memory, and rebuild only the ones whose
+   // sources are written to. Editors often save in several steps, so events are
+   // gathered until the directory has been quiet for a moment.
+   int notify = inotify_init1(IN_CLOEXEC);
+   if(notify < 0 || inotify_add_watch(notify, "./data", IN_CLOSE_WRITE|IN_MOVED_TO) < 0)
+   {
+      platform_log("ERROR: Failed to watch ./data.\n");
+      return;
+   }
+
+   bool *changed = (bool *)platform_allocate(mesh_count * sizeof(bool));
+   pack_job *rebuilt = (pack_job *)platform_allocate(mesh_count * sizeof(pack_job));
+   if(!changed || !rebuilt)
+   {
+      platform_log("ERROR: Failed to allocate the watch state.\n");
+      return;
+   }
+
+   platform_log("Watching ./data for changes.\n");
+   for(;;)
+   {
+      int timeout = -1;
+      int changed_count = 0;
+
+      pollfd poller = {notify, POLLIN, 0};
+      while(poll(&poller, 1, timeout) > 0)
+      {
+         alignas(inotify_event) char buffer[4096];
+         ssize_t size = read(notify, buffer, sizeof(buffer));
+         for(char *at = buffer; size > 0 && at < buffer + size;)
+         {
+            inotify_event *event = (inotify_event *)at;
+            if(event->len)
+            {
+               // NOTE: Any mesh might use a changed texture. Those that don't
+               // come straight back out of the cache.
+               char *extension = strrchr(event->name, '.');
+               bool texture = (extension && strcmp(extension, ".tga") == 0);
+
+               int mesh_index = find_changed_mesh(jobs, mesh_count, event->name);
+               for(int index = 0; index < mesh_count; ++index)
+               {
+                  if((texture || index == mesh_index) && !changed[index])
+                  {
+                     changed[index] = true;
+                     changed_count++;
+                  }
+               }
+            }
+
+            at += sizeof(inotify_event) + event->len;
+         }
+
+         timeout = PACKER_WATCH_SETTLE_MILLISECONDS;
+      }
+
+      if(!changed_count)
+      {
+         continue;
+      }
+
+      for(int mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+      {
+         if(changed[mesh_index])
+         {
+            pack_job *job = rebuilt + mesh_index;
+            *job = {};
+            job->basename = jobs[mesh_index].basename;
+            job->packed = jobs[mesh_index].packed;
+            job->compressed = jobs[mesh_index].compressed;
+
+            platform_enqueue_work(pack_mesh_job, job);
+         }
+      }
+      platform_complete_all_work();
+
+      // NOTE: A mesh that fails to build keeps its previous contents, so a
+      // half-finished edit never takes the game down.
+      for(int mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+      {
+         if(changed[mesh_index])
+         {
+            pack_job *job = rebuilt + mesh_index;
+            if(job->failed)
+            {
+               platform_log("ERROR: Failed to pack %s, keeping the previous version.\n", job->basename);
+               release_pack_job(job);
+            }
+            else
+            {
+               platform_log("Repacked %s.\n", job->basename);
+               release_pack_job(jobs + mesh_index);
+               jobs[mesh_index] = *job;
+            }
+
+            changed[mesh_index] = false;
+         }
+      }
+
+      write_pack(jobs, mesh_count);
+   }
+}
+#endif
+
+int main(int argument_count, char **arguments)
+{
+   // NOTE: Skip over the program name and any leading flags.
+   bool packed = false;
+   bool compressed = false;
+   bool watch = false;
+   int first_name_index = 1;
+   while(first_name_index < argument_count && arguments[first_name_index][0] == '-')
+   {
+      char *flag = arguments[first_name_index++];
+      if(strcmp(flag, "-packed") == 0) packed = true;
+      else if(strcmp(flag, "-compress") == 0) compressed = true;
+      else if(strcmp(flag, "-watch") == 0) watch = true;
+      else platform_log("WARNING: Ignoring unknown flag %s.\n", flag);
+   }
+
+   int mesh_count = argument_count - first_name_index;
+   mkdir("./build", 0755);
+   mkdir(PACK_CACHE_DIRECTORY, 0755);
+
+   // NOTE: Pack every mesh in parallel.
+   pack_job *jobs = (pack_job *)platform_allocate(mesh_count * sizeof(pack_job));
+   for(int mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+   {
+      pack_job *job = jobs + mesh_index;
+      job->basename = arguments[first_name_index + mesh_index];
+      job->packed = packed;
+      job->compressed = compressed;
+
+      platform_enqueue_work(pack_mesh_job, job);
+   }
+   platform_complete_all_work();
+
+   for(int mesh_index = 0; mesh_index < mesh_count; ++mesh_index)
+   {
+      if(jobs[mesh_index].failed)
+      {
+         platform_log("ERROR: Failed to pack %s.\n", jobs[mesh_index].basename);
+         return(1);
+      }
+   }
+
+   if(!write_pack(jobs, mesh_count))
+   {
+      return(1);
+   }
+
+   if(watch)
+   {
+#if PACKER_WATCH_SUPPORTED
+      watch_assets(jobs, mesh_count);
+#else
+      platform_log("ERROR: Watching for changes is not supported on this platform.\n");
+      return(1);
+#endif
+   }
 
    return(0);
 }
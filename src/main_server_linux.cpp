@@ -0,0 +1,648 @@
+/* /////////////////////////////////////////////////////////////////////////// */
+/* (c) copyright 2024 Lawrence D. Kern /////////////////////////////////////// */
+/* /////////////////////////////////////////////////////////////////////////// */
+
+// NOTE: This file is the entry point to the headless Linux server. It talks to
+// clients over plain UDP sockets, sleeping in epoll until datagrams arrive or
+// the tick timer fires, and moves datagrams in batches with recvmmsg and
+// sendmmsg, so an idle server uses almost no CPU and a busy one makes few
+// system calls per packet. While anyone is connected, it periodically logs how
+// long its ticks take and how many datagrams it moves.
+//
+// One process hosts many independent race sessions, each its own
+// server_context. Sessions belong to worker threads, one per core, that share
+// nothing. Every worker binds its own socket to the server port with
+// SO_REUSEPORT, and the kernel steers each client's datagrams to one of those
+// sockets by hashing the client's address, so a client only ever talks to one
+// worker. The worker seats new clients in the first of its sessions with room,
+// opening another when they're all full, and finds the session of a known
+// client through its own dispatch table. No locks are taken after startup.
+//
+// Usage: beam_server [workers] [players per session]
+
+#include "server.h"
+#include "platform_libc.cpp"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <time.h>
+
+#define LINUX_DATAGRAM_BATCH_SIZE 64
+#define LINUX_SOCKET_BUFFER_SIZE MEGABYTES(4)
+#define LINUX_STATS_INTERVAL_TICKS (5 * SERVER_TICK_RATE)
+#define LINUX_WORKER_COUNT_MAX 64
+#define LINUX_WORKER_SESSION_COUNT_MAX 32
+
+// NOTE: Each worker maps client IDs to its sessions with an open-addressing
+// table, laid out like the server's player table. Entries hold the session
+// index plus one, leaving zero for empty entries. The table is sized for every
+// session being full, so it stays at most half full.
+#define LINUX_DISPATCH_TABLE_SIZE (2 * LINUX_WORKER_SESSION_COUNT_MAX * SERVERPLAYER_COUNT_MAX)
+static_assert((LINUX_DISPATCH_TABLE_SIZE & (LINUX_DISPATCH_TABLE_SIZE - 1)) == 0, "Dispatch table size must be a power of two.");
+static_assert(LINUX_WORKER_SESSION_COUNT_MAX < 256, "Session indices don't fit the dispatch table.");
+
+struct linux_server_stats
+{
+   u64 tick_count;
+   u64 tick_microseconds;
+   u64 tick_microseconds_max;
+
+   u64 datagrams_received;
+   u64 datagrams_sent;
+};
+
+struct linux_receive_batch
+{
+   mmsghdr headers[LINUX_DATAGRAM_BATCH_SIZE];
+   iovec vectors[LINUX_DATAGRAM_BATCH_SIZE];
+   sockaddr_in addresses[LINUX_DATAGRAM_BATCH_SIZE];
+   u8 buffers[LINUX_DATAGRAM_BATCH_SIZE][SERVER_PACKET_SIZE];
+};
+
+struct linux_send_batch
+{
+   int count;
+   mmsghdr headers[LINUX_DATAGRAM_BATCH_SIZE];
+   iovec vectors[LINUX_DATAGRAM_BATCH_SIZE];
+   sockaddr_in addresses[LINUX_DATAGRAM_BATCH_SIZE];
+};
+
+struct linux_worker
+{
+   int index;
+   pthread_t thread;
+
+   int socket_handle;
+   int epoll_handle;
+   int timer_handle;
+
+   int players_per_session;
+   int session_count;
+   server_context *sessions[LINUX_WORKER_SESSION_COUNT_MAX];
+
+   u64 dispatch_client_ids[LINUX_DISPATCH_TABLE_SIZE];
+   u8 dispatch_sessions[LINUX_DISPATCH_TABLE_SIZE];
+
+   linux_server_stats stats;
+   linux_receive_batch receive;
+   linux_send_batch send;
+};
+
+// NOTE: Cleared once by the main thread on shutdown. Workers notice within a
+// tick.
+static u32 linux_running = 1;
+
+static u64 linux_get_microseconds(void)
+{
+   timespec time;
+   clock_gettime(CLOCK_MONOTONIC, &time);
+
+   u64 result = (u64)time.tv_sec*1000000 + (u64)time.tv_nsec/1000;
+   return(result);
+}
+
+static int linux_open_socket(int port)
+{
+   int result = socket(AF_INET, SOCK_DGRAM|SOCK_NONBLOCK|SOCK_CLOEXEC, 0);
+   if(result < 0)
+   {
+      platform_log("ERROR: Failed to open UDP socket. %s\n", strerror(errno));
+      return(-1);
+   }
+
+   // NOTE: Larger kernel buffers absorb bursts between wakeups. The kernel may
+   // clamp these, which is fine.
+   int buffer_size = LINUX_SOCKET_BUFFER_SIZE;
+   setsockopt(result, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+   setsockopt(result, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+
+   // NOTE: Every worker binds its own socket to the same port.
+   int reuse = 1;
+   if(setsockopt(result, SOL_SOCKET, SO_REUSEPORT, &reuse, sizeof(reuse)) < 0)
+   {
+      platform_log("ERROR: Failed to share UDP port %d between workers. %s\n", port, strerror(errno));
+      close(result);
+      return(-1);
+   }
+
+   sockaddr_in address = {};
+   address.sin_family = AF_INET;
+   address.sin_addr.s_addr = htonl(INADDR_ANY);
+   address.sin_port = htons(port);
+   if(bind(result, (sockaddr *)&address, sizeof(address)) < 0)
+   {
+      platform_log("ERROR: Failed to bind UDP socket to port %d. %s\n", port, strerror(errno));
+      close(result);
+      return(-1);
+   }
+
+   return(result);
+}
+
+static void linux_prepare_receive(linux_receive_batch *batch)
+{
+   // NOTE: recvmmsg overwrites the address and message lengths, so reset them
+   // before every call.
+   for(int index = 0; index < LINUX_DATAGRAM_BATCH_SIZE; ++index)
+   {
+      batch->vectors[index].iov_base = batch->buffers[index];
+      batch->vectors[index].iov_len = sizeof(batch->buffers[index]);
+
+      msghdr *header = &batch->headers[index].msg_hdr;
+      memset(header, 0, sizeof(*header));
+      header->msg_name = batch->addresses + index;
+      header->msg_namelen = sizeof(batch->addresses[index]);
+      header->msg_iov = batch->vectors + index;
+      header->msg_iovlen = 1;
+      batch->headers[index].msg_len = 0;
+   }
+}
+
+static void linux_flush_sends(int socket_handle, linux_send_batch *batch)
+{
+   int sent = 0;
+   while(sent < batch->count)
+   {
+      int count = sendmmsg(socket_handle, batch->headers + sent, batch->count - sent, 0);
+      if(count < 0)
+      {
+         if(errno == EINTR)
+         {
+            continue;
+         }
+
+         // NOTE: A full send buffer drops the rest of the batch, the same as
+         // if the datagrams had been lost in flight.
+         if(errno != EAGAIN && errno != EWOULDBLOCK)
+         {
+            platform_log("ERROR: Failed to send datagrams. %s\n", strerror(errno));
+         }
+         break;
+      }
+
+      sent += count;
+   }
+
+   batch->count = 0;
+}
+
+static void linux_push_send(int socket_handle, linux_send_batch *batch, server_address address, void *data, memsize size)
+{
+   if(batch->count == LINUX_DATAGRAM_BATCH_SIZE)
+   {
+      linux_flush_sends(socket_handle, batch);
+   }
+
+   // NOTE: The data must stay valid until the batch is flushed.
+   int index = batch->count++;
+
+   sockaddr_in *destination = batch->addresses + index;
+   memset(destination, 0, sizeof(*destination));
+   destination->sin_family = AF_INET;
+   destination->sin_addr.s_addr = address.host;
+   destination->sin_port = address.port;
+
+   batch->vectors[index].iov_base = data;
+   batch->vectors[index].iov_len = size;
+
+   msghdr *header = &batch->headers[index].msg_hdr;
+   memset(header, 0, sizeof(*header));
+   header->msg_name = batch->addresses + index;
+   header->msg_namelen = sizeof(batch->addresses[index]);
+   header->msg_iov = batch->vectors + index;
+   header->msg_iovlen = 1;
+}
+
+static u32 linux_get_dispatch_table_index(u64 client_id)
+{
+   // NOTE: Fibonacci hashing, the same as the server's player table.
+   u64 hash = client_id * 0x9E3779B97F4A7C15ull;
+   u32 result = (u32)(hash >> 32) & (LINUX_DISPATCH_TABLE_SIZE - 1);
+
+   return(result);
+}
+
+static void linux_insert_dispatch(linux_worker *worker, u64 client_id, int session_index)
+{
+   u32 index = linux_get_dispatch_table_index(client_id);
+   while(worker->dispatch_sessions[index])
+   {
+      index = (index + 1) & (LINUX_DISPATCH_TABLE_SIZE - 1);
+   }
+
+   worker->dispatch_client_ids[index] = client_id;
+   worker->dispatch_sessions[index] = (u8)(session_index + 1);
+}
+
+static int linux_find_dispatch(linux_worker *worker, u64 client_id)
+{
+   int result = -1;
+
+   u32 index = linux_get_dispatch_table_index(client_id);
+   while(worker->dispatch_sessions[index])
+   {
+      if(worker->dispatch_client_ids[index] == client_id)
+      {
+         result = worker->dispatch_sessions[index] - 1;
+         break;
+      }
+
+      index = (index + 1) & (LINUX_DISPATCH_TABLE_SIZE - 1);
+   }
+
+   return(result);
+}
+
+static void linux_rebuild_dispatch(linux_worker *worker)
+{
+   // NOTE: Sessions only drop players while ticking, so rather than delete
+   // entries, the table is rebuilt after any tick that dropped someone.
+   memset(worker->dispatch_sessions, 0, sizeof(worker->dispatch_sessions));
+
+   for(int session_index = 0; session_index < worker->session_count; ++session_index)
+   {
+      server_context *session = worker->sessions[session_index];
+      for(int slot = 0; slot < session->player_count; ++slot)
+      {
+         linux_insert_dispatch(worker, session->players[slot].client_id, session_index);
+      }
+   }
+}
+
+static int linux_seat_client(linux_worker *worker, u64 client_id)
+{
+   int result = -1;
+
+   for(int session_index = 0; session_index < worker->session_count; ++session_index)
+   {
+      if(worker->sessions[session_index]->player_count < worker->players_per_session)
+      {
+         result = session_index;
+         break;
+      }
+   }
+
+   if(result < 0 && worker->session_count < LINUX_WORKER_SESSION_COUNT_MAX)
+   {
+      // NOTE: Sessions are large, but calloc leaves the pages of unused
+      // player slots untouched.
+      server_context *session = (server_context *)platform_allocate(sizeof(server_context));
+      if(session)
+      {
+         result = worker->session_count++;
+         worker->sessions[result] = session;
+
+         platform_log("Worker %d opened session %d.\n", worker->index, result);
+      }
+   }
+
+   if(result >= 0)
+   {
+      linux_insert_dispatch(worker, client_id, result);
+   }
+   else
+   {
+      platform_log("WARNING: Client %llu was turned away from a full worker.\n", client_id);
+   }
+
+   return(result);
+}
+
+static void linux_receive_datagrams(linux_worker *worker)
+{
+   linux_receive_batch *receive = &worker->receive;
+
+   // NOTE: Drain the socket. A short batch means it was empty when the call
+   // returned, and anything arriving later will wake epoll again.
+   int count = LINUX_DATAGRAM_BATCH_SIZE;
+   while(count == LINUX_DATAGRAM_BATCH_SIZE && ATOMIC_LOAD(&linux_running))
+   {
+      linux_prepare_receive(receive);
+
+      count = recvmmsg(worker->socket_handle, receive->headers, LINUX_DATAGRAM_BATCH_SIZE, MSG_DONTWAIT, 0);
+      if(count < 0)
+      {
+         if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+         {
+            platform_log("ERROR: Failed to receive datagrams. %s\n", strerror(errno));
+         }
+         break;
+      }
+
+      worker->stats.datagrams_received += count;
+      for(int index = 0; index < count; ++index)
+      {
+         mmsghdr *message = receive->headers + index;
+
+         // NOTE: Ignore anything that isn't exactly one client packet.
+         if(message->msg_len != sizeof(game_packet) || (message->msg_hdr.msg_flags & MSG_TRUNC))
+         {
+            continue;
+         }
+
+         game_packet in;
+         memcpy(&in, receive->buffers[index], sizeof(in));
+
+         int session_index = linux_find_dispatch(worker, in.client_id);
+         if(session_index < 0)
+         {
+            session_index = linux_seat_client(worker, in.client_id);
+            if(session_index < 0)
+            {
+               continue;
+            }
+         }
+
+         server_address address;
+         address.host = receive->addresses[index].sin_addr.s_addr;
+         address.port = receive->addresses[index].sin_port;
+
+         server_receive_packet(worker->sessions[session_index], &in, address);
+      }
+   }
+}
+
+static void linux_run_tick(linux_worker *worker)
+{
+   linux_server_stats *stats = &worker->stats;
+
+   int players_before = 0;
+   int players_after = 0;
+   int sessions_active = 0;
+
+   u64 start = linux_get_microseconds();
+   for(int session_index = 0; session_index < worker->session_count; ++session_index)
+   {
+      server_context *session = worker->sessions[session_index];
+
+      players_before += session->player_count;
+      server_tick(session);
+      players_after += session->player_count;
+      sessions_active += (session->player_count > 0);
+
+      for(int slot = 0; slot < session->player_count; ++slot)
+      {
+         server_client *client = session->clients + slot;
+         for(int index = 0; index < client->datagram_count; ++index)
+         {
+            network_datagram *datagram = client->datagrams + index;
+            linux_push_send(worker->socket_handle, &worker->send, client->address, datagram->data, datagram->size);
+         }
+         stats->datagrams_sent += client->datagram_count;
+      }
+   }
+   linux_flush_sends(worker->socket_handle, &worker->send);
+   u64 elapsed = linux_get_microseconds() - start;
+
+   if(players_after < players_before)
+   {
+      linux_rebuild_dispatch(worker);
+   }
+
+   stats->tick_count++;
+   stats->tick_microseconds += elapsed;
+   stats->tick_microseconds_max = MAXIMUM(stats->tick_microseconds_max, elapsed);
+
+   if(stats->tick_count == LINUX_STATS_INTERVAL_TICKS)
+   {
+      if(players_after > 0)
+      {
+         float seconds = (float)LINUX_STATS_INTERVAL_TICKS / (float)SERVER_TICK_RATE;
+         platform_log("Worker %d: tick %.3fms average, %.3fms max, %d sessions, %d players, %.0f datagrams/s in, %.0f datagrams/s out.\n",
+                      worker->index,
+                      (float)stats->tick_microseconds / (1000.0f * stats->tick_count),
+                      (float)stats->tick_microseconds_max / 1000.0f,
+                      sessions_active,
+                      players_after,
+                      (float)stats->datagrams_received / seconds,
+                      (float)stats->datagrams_sent / seconds);
+      }
+
+      *stats = {};
+   }
+}
+
+static int linux_create_tick_timer(int tick_rate)
+{
+   int result = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK|TFD_CLOEXEC);
+   if(result >= 0)
+   {
+      itimerspec interval = {};
+      interval.it_interval.tv_nsec = 1000000000 / tick_rate;
+      interval.it_value = interval.it_interval;
+      if(timerfd_settime(result, 0, &interval, 0) < 0)
+      {
+         close(result);
+         result = -1;
+      }
+   }
+
+   return(result);
+}
+
+static bool linux_open_worker(linux_worker *worker)
+{
+   worker->socket_handle = linux_open_socket(SERVER_PORT);
+   worker->epoll_handle = epoll_create1(EPOLL_CLOEXEC);
+   worker->timer_handle = linux_create_tick_timer(SERVER_TICK_RATE);
+   if(worker->socket_handle < 0)
+   {
+      return(false);
+   }
+   if(worker->epoll_handle < 0)
+   {
+      platform_log("ERROR: Failed to create epoll instance. %s\n", strerror(errno));
+      return(false);
+   }
+   if(worker->timer_handle < 0)
+   {
+      platform_log("ERROR: Failed to create tick timer. %s\n", strerror(errno));
+      return(false);
+   }
+
+   int watched_handles[] = {worker->socket_handle, worker->timer_handle};
+   for(int index = 0; index < countof(watched_handles); ++index)
+   {
+      epoll_event event = {};
+      event.events = EPOLLIN;
+      event.data.fd = watched_handles[index];
+      if(epoll_ctl(worker->epoll_handle, EPOLL_CTL_ADD, watched_handles[index], &event) < 0)
+      {
+         platform_log("ERROR: Failed to watch server handles. %s\n", strerror(errno));
+         return(false);
+      }
+   }
+
+   return(true);
+}
+
+static void linux_close_worker(linux_worker *worker)
+{
+   for(int session_index = 0; session_index < worker->session_count; ++session_index)
+   {
+      platform_deallocate(worker->sessions[session_index]);
+   }
+
+   int handles[] = {worker->timer_handle, worker->epoll_handle, worker->socket_handle};
+   for(int index = 0; index < countof(handles); ++index)
+   {
+      if(handles[index] >= 0)
+      {
+         close(handles[index]);
+      }
+   }
+}
+
+static void *linux_run_worker(void *data)
+{
+   linux_worker *worker = (linux_worker *)data;
+
+   // NOTE: Keep each worker on its own core where there are enough of them,
+   // so its sessions stay in that core's caches.
+   long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+   if(processor_count > 0)
+   {
+      cpu_set_t processors;
+      CPU_ZERO(&processors);
+      CPU_SET(worker->index % processor_count, &processors);
+      pthread_setaffinity_np(pthread_self(), sizeof(processors), &processors);
+   }
+
+   while(ATOMIC_LOAD(&linux_running))
+   {
+      // NOTE: The tick timer wakes the worker at least once a tick, so it sees
+      // shutdown without being signalled.
+      epoll_event events[2];
+      int ready = epoll_wait(worker->epoll_handle, events, countof(events), -1);
+      if(ready < 0)
+      {
+         if(errno == EINTR)
+         {
+            continue;
+         }
+
+         platform_log("ERROR: Failed to wait for datagrams. %s\n", strerror(errno));
+         break;
+      }
+
+      // NOTE: Take in all pending input before ticking, so the tick applies it.
+      bool tick_due = false;
+      for(int index = 0; index < ready; ++index)
+      {
+         if(events[index].data.fd == worker->socket_handle)
+         {
+            linux_receive_datagrams(worker);
+         }
+         else if(events[index].data.fd == worker->timer_handle)
+         {
+            u64 expirations;
+            tick_due = (read(worker->timer_handle, &expirations, sizeof(expirations)) == sizeof(expirations));
+         }
+      }
+
+      // NOTE: Ticks missed while the worker was descheduled are skipped rather
+      // than run back to back.
+      if(tick_due)
+      {
+         linux_run_tick(worker);
+      }
+   }
+
+   return(0);
+}
+
+int main(int argument_count, char **arguments)
+{
+   int worker_count = (argument_count > 1) ? atoi(arguments[1]) : 1;
+   int players_per_session = (argument_count > 2) ? atoi(arguments[2]) : SERVERPLAYER_COUNT_MAX;
+   if(worker_count < 1 || worker_count > LINUX_WORKER_COUNT_MAX ||
+      players_per_session < 1 || players_per_session > SERVERPLAYER_COUNT_MAX)
+   {
+      platform_log("Usage: %s [workers 1-%d] [players per session 1-%d]\n",
+                   arguments[0], LINUX_WORKER_COUNT_MAX, SERVERPLAYER_COUNT_MAX);
+      return(1);
+   }
+
+   // NOTE: Only the main thread takes shutdown signals. The workers inherit
+   // this mask.
+   sigset_t signals;
+   sigemptyset(&signals);
+   sigaddset(&signals, SIGINT);
+   sigaddset(&signals, SIGTERM);
+   pthread_sigmask(SIG_BLOCK, &signals, 0);
+
+   // NOTE: The workers are too large for the stack. Every socket is bound
+   // before any worker starts, so the kernel never reshuffles clients between
+   // workers once they're talking.
+   linux_worker *workers[LINUX_WORKER_COUNT_MAX] = {};
+   bool opened = true;
+   for(int index = 0; index < worker_count && opened; ++index)
+   {
+      linux_worker *worker = (linux_worker *)platform_allocate(sizeof(linux_worker));
+      if(!worker)
+      {
+         platform_log("ERROR: Failed to allocate server memory.\n");
+         opened = false;
+         break;
+      }
+
+      workers[index] = worker;
+      worker->index = index;
+      worker->players_per_session = players_per_session;
+      opened = linux_open_worker(worker);
+   }
+
+   int started_count = 0;
+   if(opened)
+   {
+      for(; started_count < worker_count; ++started_count)
+      {
+         linux_worker *worker = workers[started_count];
+         if(pthread_create(&worker->thread, 0, linux_run_worker, worker) != 0)
+         {
+            platform_log("ERROR: Failed to start worker %d.\n", started_count);
+            break;
+         }
+      }
+   }
+
+   if(started_count == worker_count)
+   {
+      platform_log("beam server has started on port %d at %d ticks per second, with %d workers and up to %d players per session.\n",
+                   SERVER_PORT, SERVER_TICK_RATE, worker_count, players_per_session);
+
+      int signal_number;
+      sigwait(&signals, &signal_number);
+   }
+
+   ATOMIC_STORE(&linux_running, 0);
+   for(int index = 0; index < started_count; ++index)
+   {
+      pthread_join(workers[index]->thread, 0);
+   }
+
+   for(int index = 0; index < worker_count; ++index)
+   {
+      if(workers[index])
+      {
+         linux_close_worker(workers[index]);
+         platform_deallocate(workers[index]);
+      }
+   }
+
+   if(started_count == worker_count)
+   {
+      platform_log("beam server has shut down.\n");
+      return(0);
+   }
+
+   return(1);
+}
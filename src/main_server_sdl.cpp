@@ -33,18 +33,41 @@ int main(int argument_count, char **arguments)
 
    plog("beam server has started on %s:%d.\n", SERVER_HOST, SERVER_PORT);
 
-   server_context server = {};
+   static server_context server = {};
+   Uint64 next_tick = SDL_GetTicks();
    while(1)
    {
-      if(SDLNet_UDP_Recv(sdl_socket, sdl_packet))
+      while(SDLNet_UDP_Recv(sdl_socket, sdl_packet) == 1)
       {
-         game_packet *in = (game_packet *)sdl_packet->data;
-         server_packet out = server_update(&server, in);
+         if(sdl_packet->len == sizeof(game_packet))
+         {
+            server_address address = {sdl_packet->address.host, sdl_packet->address.port};
+            server_receive_packet(&server, (game_packet *)sdl_packet->data, address);
+         }
+      }
 
-         SDL_memcpy(sdl_packet->data, (void *)&out, sizeof(out));
-         sdl_packet->len = sizeof(out);
+      Uint64 now = SDL_GetTicks();
+      if(now < next_tick)
+      {
+         SDL_Delay(1);
+         continue;
+      }
+      next_tick = MAXIMUM(next_tick + (1000 / SERVER_TICK_RATE), now);
+
+      server_tick(&server);
+      for(int slot = 0; slot < server.player_count; ++slot)
+      {
+         server_client *client = server.clients + slot;
+         for(int index = 0; index < client->datagram_count; ++index)
+         {
+            network_datagram *datagram = client->datagrams + index;
+            SDL_memcpy(sdl_packet->data, datagram->data, datagram->size);
+            sdl_packet->len = datagram->size;
+            sdl_packet->address.host = client->address.host;
+            sdl_packet->address.port = client->address.port;
 
-         SDLNet_UDP_Send(sdl_socket, -1, sdl_packet);
+            SDLNet_UDP_Send(sdl_socket, -1, sdl_packet);
+         }
       }
    }
 
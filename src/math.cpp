@@ -28,9 +28,16 @@ static float tangent(float turns)
    return(result);
 }
 
-static float arctangent(float turns)
+static float arctangent(float value)
 {
-   float result = atanf(TAU32 * turns);
+   float result = atanf(value) / TAU32;
+   return(result);
+}
+
+static float arctangent2(float y, float x)
+{
+   // NOTE: Returns the angle of the vector (x, y) in turns, from -0.5 to 0.5.
+   float result = atan2f(y, x) / TAU32;
    return(result);
 }
 #undef TAU32
@@ -46,11 +53,45 @@ static int absolute_value(int value)
    return abs(value);
 }
 
+static float absolute_value(float value)
+{
+   return fabsf(value);
+}
+
 static float square_root(float value)
 {
    return sqrtf(value);
 }
 
+static int round_to_int(float value)
+{
+   return (int)floorf(value + 0.5f);
+}
+
+static u32 spread_bits(u32 value)
+{
+   // NOTE: Move the low 16 bits of value into the even bit positions.
+   value &= 0xFFFF;
+   value = (value | (value << 8)) & 0x00FF00FF;
+   value = (value | (value << 4)) & 0x0F0F0F0F;
+   value = (value | (value << 2)) & 0x33333333;
+   value = (value | (value << 1)) & 0x55555555;
+   return(value);
+}
+
+static u32 morton_index(u32 x, u32 y, int width_log2, int height_log2)
+{
+   // NOTE: Interleave the low bits shared by both dimensions of a power-of-two
+   // grid, then append the remaining high bits of the longer dimension.
+   int shared_log2 = MINIMUM(width_log2, height_log2);
+   u32 mask = (1u << shared_log2) - 1;
+
+   u32 result = spread_bits(x & mask) | (spread_bits(y & mask) << 1);
+   result |= ((x >> shared_log2) | (y >> shared_log2)) << (2 * shared_log2);
+
+   return(result);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 static vec2 v2(float x, float y)
@@ -451,6 +492,19 @@ static mat4 operator*(mat4 a, mat4 b)
 
 static mat4 operator*=(mat4 &a, mat4 b) {a = a*b; return(a);}
 
+static mat4 transpose(mat4 m)
+{
+   mat4 result;
+   for(int row = 0; row < 4; ++row)
+   {
+      for(int col = 0; col < 4; ++col)
+      {
+         result.e[row][col] = m.e[col][row];
+      }
+   }
+   return(result);
+}
+
 vec3 project(mat4 projection, vec3 v)
 {
    // NOTE: Shuffle vertex coordinates to match the clip space coordinate system
@@ -37,6 +37,24 @@ static void *arena_allocate(memarena *arena, memsize size)
    return(result);
 }
 
+// arena_allocate_aligned allocates the requested number of bytes from a given
+// arena, starting at an address that is a multiple of alignment (a power of
+// two). If not enough space is available, it returns 0.
+static void *arena_allocate_aligned(memarena *arena, memsize size, memsize alignment)
+{
+   void *result = 0;
+
+   memsize address = (memsize)(arena->base + arena->used);
+   memsize padding = ((address + alignment - 1) & ~(alignment - 1)) - address;
+   if(padding <= (arena->size - arena->used) && size <= (arena->size - arena->used - padding))
+   {
+      arena->used += padding;
+      result = arena_allocate(arena, size);
+   }
+
+   return(result);
+}
+
 // arena_reset deallocates everything from a given arena.
 // Note that the memory buffer itself is not cleared in any way.
 static void arena_reset(memarena *arena)
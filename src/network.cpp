@@ -0,0 +1,441 @@
+/* /////////////////////////////////////////////////////////////////////////// */
+/* (c) copyright 2024 Lawrence D. Kern /////////////////////////////////////// */
+/* /////////////////////////////////////////////////////////////////////////// */
+
+static bit_writer make_bit_writer(u8 *data, int capacity)
+{
+   bit_writer result = {};
+   result.data = data;
+   result.capacity = capacity;
+
+   return(result);
+}
+
+static void write_bits(bit_writer *writer, u32 value, int bit_count)
+{
+   assert(bit_count <= 32);
+
+   u64 mask = ((u64)1 << bit_count) - 1;
+   writer->scratch |= ((u64)value & mask) << writer->scratch_bits;
+   writer->scratch_bits += bit_count;
+
+   while(writer->scratch_bits >= 8)
+   {
+      if(writer->size < writer->capacity)
+      {
+         writer->data[writer->size++] = (u8)writer->scratch;
+      }
+      else
+      {
+         writer->overflowed = true;
+      }
+
+      writer->scratch >>= 8;
+      writer->scratch_bits -= 8;
+   }
+}
+
+static int flush_bits(bit_writer *writer)
+{
+   // NOTE: Pad the final byte with zeros. Returns the number of bytes written,
+   // or zero if they didn't fit.
+   if(writer->scratch_bits > 0)
+   {
+      write_bits(writer, 0, 8 - writer->scratch_bits);
+   }
+
+   int result = (writer->overflowed) ? 0 : writer->size;
+   return(result);
+}
+
+static bit_reader make_bit_reader(u8 *data, int size)
+{
+   bit_reader result = {};
+   result.data = data;
+   result.size = size;
+
+   return(result);
+}
+
+static u32 read_bits(bit_reader *reader, int bit_count)
+{
+   assert(bit_count <= 32);
+
+   while(reader->scratch_bits < bit_count)
+   {
+      if(reader->position < reader->size)
+      {
+         reader->scratch |= (u64)reader->data[reader->position++] << reader->scratch_bits;
+      }
+      else
+      {
+         reader->overflowed = true;
+      }
+      reader->scratch_bits += 8;
+   }
+
+   u64 mask = ((u64)1 << bit_count) - 1;
+   u32 result = (u32)(reader->scratch & mask);
+
+   reader->scratch >>= bit_count;
+   reader->scratch_bits -= bit_count;
+
+   return(result);
+}
+
+static u32 zigzag_encode(s32 value)
+{
+   u32 result = ((u32)value << 1) ^ (u32)(value >> 31);
+   return(result);
+}
+
+static s32 zigzag_decode(u32 value)
+{
+   s32 result = (s32)(value >> 1) ^ -(s32)(value & 1);
+   return(result);
+}
+
+static s32 quantize_coordinate(float value)
+{
+   s32 limit = (1 << (NETWORK_POSITION_BITS - 1)) - 1;
+
+   float scaled = value * NETWORK_POSITION_SCALE;
+   scaled = MINIMUM(MAXIMUM(scaled, (float)-limit), (float)limit);
+
+   s32 result = (s32)(scaled + ((scaled < 0.0f) ? -0.5f : 0.5f));
+   return(result);
+}
+
+static float dequantize_coordinate(s32 value)
+{
+   float result = (float)value / NETWORK_POSITION_SCALE;
+   return(result);
+}
+
+static bool is_snapshot_player_present(network_snapshot *snapshot, int index)
+{
+   bool result = (snapshot->present[index / 32] >> (index % 32)) & 1;
+   return(result);
+}
+
+static void set_snapshot_player(network_snapshot *snapshot, int index, vec3 position)
+{
+   snapshot->present[index / 32] |= (1u << (index % 32));
+   snapshot->positions[index][0] = quantize_coordinate(position.x);
+   snapshot->positions[index][1] = quantize_coordinate(position.y);
+   snapshot->positions[index][2] = quantize_coordinate(position.z);
+}
+
+static vec3 get_snapshot_player_position(network_snapshot *snapshot, int index)
+{
+   vec3 result;
+   result.x = dequantize_coordinate(snapshot->positions[index][0]);
+   result.y = dequantize_coordinate(snapshot->positions[index][1]);
+   result.z = dequantize_coordinate(snapshot->positions[index][2]);
+
+   return(result);
+}
+
+static bool snapshot_player_changed(network_snapshot *current, network_snapshot *baseline, int index)
+{
+   bool present = is_snapshot_player_present(current, index);
+   bool result = (present != is_snapshot_player_present(baseline, index));
+   if(!result && present)
+   {
+      s32 *a = current->positions[index];
+      s32 *b = baseline->positions[index];
+      result = (a[0] != b[0] || a[1] != b[1] || a[2] != b[2]);
+   }
+
+   return(result);
+}
+
+static int write_snapshot(u8 *data, int capacity, network_snapshot *current, network_snapshot *baseline, int recipient_index)
+{
+   // NOTE: Without a baseline, delta against an empty snapshot, which sends
+   // every present player in full. Returns the encoded size in bytes, or zero
+   // if it didn't fit.
+   network_snapshot empty = {};
+   u32 baseline_age = 0;
+   if(baseline)
+   {
+      baseline_age = current->tick - baseline->tick;
+      assert(baseline_age > 0 && baseline_age < NETWORK_SNAPSHOT_HISTORY);
+   }
+   else
+   {
+      baseline = &empty;
+   }
+
+   int index_count = 0;
+   for(int index = 0; index < SERVERPLAYER_COUNT_MAX; ++index)
+   {
+      if(is_snapshot_player_present(current, index) || is_snapshot_player_present(baseline, index))
+      {
+         index_count = index + 1;
+      }
+   }
+
+   bit_writer writer = make_bit_writer(data, capacity);
+   write_bits(&writer, current->tick, 32);
+   write_bits(&writer, baseline_age, NETWORK_BASELINE_AGE_BITS);
+   write_bits(&writer, recipient_index, NETWORK_INDEX_BITS);
+   write_bits(&writer, current->input_sequence, 32);
+   write_bits(&writer, index_count, NETWORK_INDEX_BITS + 1);
+
+   u32 small_delta_limit = 1u << NETWORK_DELTA_BITS;
+   for(int index = 0; index < index_count; ++index)
+   {
+      bool present = is_snapshot_player_present(current, index);
+      bool changed = snapshot_player_changed(current, baseline, index);
+      write_bits(&writer, changed, 1);
+      if(changed)
+      {
+         write_bits(&writer, present, 1);
+      }
+      if(!present)
+      {
+         continue;
+      }
+
+      write_bits(&writer, current->sample_ages[index], NETWORK_SAMPLE_AGE_BITS);
+      if(!changed)
+      {
+         continue;
+      }
+
+      bool in_baseline = is_snapshot_player_present(baseline, index);
+      for(int axis = 0; axis < 3; ++axis)
+      {
+         s32 value = current->positions[index][axis];
+         if(in_baseline)
+         {
+            u32 delta = zigzag_encode(value - baseline->positions[index][axis]);
+            bool small = (delta < small_delta_limit);
+            write_bits(&writer, small, 1);
+            if(small)
+            {
+               write_bits(&writer, delta, NETWORK_DELTA_BITS);
+               continue;
+            }
+         }
+
+         write_bits(&writer, (u32)value, NETWORK_POSITION_BITS);
+      }
+   }
+
+   int result = flush_bits(&writer);
+   return(result);
+}
+
+static bool read_snapshot(network_snapshot *result, int *recipient_index, u8 *data, int size, network_snapshot *history)
+{
+   // NOTE: history is indexed by tick modulo NETWORK_SNAPSHOT_HISTORY. Fails
+   // if the stream is malformed or its baseline is no longer in the history.
+   bit_reader reader = make_bit_reader(data, size);
+   u32 tick = read_bits(&reader, 32);
+   u32 baseline_age = read_bits(&reader, NETWORK_BASELINE_AGE_BITS);
+   int recipient = read_bits(&reader, NETWORK_INDEX_BITS);
+   u32 input_sequence = read_bits(&reader, 32);
+   int index_count = read_bits(&reader, NETWORK_INDEX_BITS + 1);
+   if(reader.overflowed || index_count > SERVERPLAYER_COUNT_MAX || baseline_age >= NETWORK_SNAPSHOT_HISTORY)
+   {
+      return(false);
+   }
+
+   network_snapshot baseline = {};
+   if(baseline_age > 0)
+   {
+      u32 baseline_tick = tick - baseline_age;
+      network_snapshot *entry = history + (baseline_tick % NETWORK_SNAPSHOT_HISTORY);
+      if(entry->tick != baseline_tick)
+      {
+         return(false);
+      }
+      baseline = *entry;
+   }
+
+   network_snapshot snapshot = baseline;
+   snapshot.tick = tick;
+   snapshot.input_sequence = input_sequence;
+
+   for(int index = 0; index < index_count; ++index)
+   {
+      bool changed = read_bits(&reader, 1);
+      if(changed)
+      {
+         u32 present_bit = (1u << (index % 32));
+         if(read_bits(&reader, 1))
+         {
+            snapshot.present[index / 32] |= present_bit;
+         }
+         else
+         {
+            snapshot.present[index / 32] &= ~present_bit;
+         }
+      }
+      if(!is_snapshot_player_present(&snapshot, index))
+      {
+         snapshot.sample_ages[index] = 0;
+         continue;
+      }
+
+      snapshot.sample_ages[index] = (u8)read_bits(&reader, NETWORK_SAMPLE_AGE_BITS);
+      if(!changed)
+      {
+         continue;
+      }
+
+      bool in_baseline = is_snapshot_player_present(&baseline, index);
+      for(int axis = 0; axis < 3; ++axis)
+      {
+         if(in_baseline && read_bits(&reader, 1))
+         {
+            s32 delta = zigzag_decode(read_bits(&reader, NETWORK_DELTA_BITS));
+            snapshot.positions[index][axis] = baseline.positions[index][axis] + delta;
+         }
+         else
+         {
+            // NOTE: Sign extend the full value.
+            u32 value = read_bits(&reader, NETWORK_POSITION_BITS);
+            int shift = 32 - NETWORK_POSITION_BITS;
+            snapshot.positions[index][axis] = (s32)(value << shift) >> shift;
+         }
+      }
+   }
+
+   if(reader.overflowed)
+   {
+      return(false);
+   }
+
+   *result = snapshot;
+   *recipient_index = recipient;
+
+   return(true);
+}
+
+static int write_fragments(network_datagram *datagrams, u8 *snapshot, int snapshot_size, u32 tick)
+{
+   // NOTE: Returns the number of fragments written, at most
+   // NETWORK_FRAGMENT_COUNT_MAX.
+   int result = (snapshot_size + NETWORK_FRAGMENT_PAYLOAD_SIZE - 1) / NETWORK_FRAGMENT_PAYLOAD_SIZE;
+   assert(result > 0 && result <= NETWORK_FRAGMENT_COUNT_MAX);
+
+   for(int index = 0; index < result; ++index)
+   {
+      network_datagram *datagram = datagrams + index;
+
+      bit_writer writer = make_bit_writer(datagram->data, NETWORK_FRAGMENT_HEADER_SIZE);
+      write_bits(&writer, tick, 32);
+      write_bits(&writer, index, 8);
+      write_bits(&writer, result, 8);
+      int header_size = flush_bits(&writer);
+      assert(header_size == NETWORK_FRAGMENT_HEADER_SIZE);
+
+      int offset = index * NETWORK_FRAGMENT_PAYLOAD_SIZE;
+      int payload_size = MINIMUM(snapshot_size - offset, NETWORK_FRAGMENT_PAYLOAD_SIZE);
+      for(int byte_index = 0; byte_index < payload_size; ++byte_index)
+      {
+         datagram->data[header_size + byte_index] = snapshot[offset + byte_index];
+      }
+
+      datagram->size = header_size + payload_size;
+   }
+
+   return(result);
+}
+
+static bool receive_fragment(network_reassembly *reassembly, u8 *data, int size)
+{
+   // NOTE: Returns true once every fragment of the snapshot has arrived. A
+   // fragment from a newer snapshot abandons any partial one, and fragments
+   // from older snapshots are ignored.
+   bit_reader reader = make_bit_reader(data, size);
+   u32 tick = read_bits(&reader, 32);
+   int index = read_bits(&reader, 8);
+   int count = read_bits(&reader, 8);
+   if(reader.overflowed || count == 0 || count > NETWORK_FRAGMENT_COUNT_MAX || index >= count)
+   {
+      return(false);
+   }
+
+   int payload_size = size - NETWORK_FRAGMENT_HEADER_SIZE;
+   bool last = (index == count - 1);
+   if((!last && payload_size != NETWORK_FRAGMENT_PAYLOAD_SIZE) || (last && payload_size <= 0))
+   {
+      return(false);
+   }
+
+   if(reassembly->fragment_count == 0 || (s32)(tick - reassembly->tick) > 0)
+   {
+      reassembly->tick = tick;
+      reassembly->fragment_count = count;
+      reassembly->received_mask = 0;
+      reassembly->size = 0;
+   }
+
+   u32 bit = (1u << index);
+   if(tick != reassembly->tick || count != reassembly->fragment_count || (reassembly->received_mask & bit))
+   {
+      return(false);
+   }
+
+   u8 *payload = data + NETWORK_FRAGMENT_HEADER_SIZE;
+   u8 *destination = reassembly->data + index * NETWORK_FRAGMENT_PAYLOAD_SIZE;
+   for(int byte_index = 0; byte_index < payload_size; ++byte_index)
+   {
+      destination[byte_index] = payload[byte_index];
+   }
+
+   reassembly->received_mask |= bit;
+   if(last)
+   {
+      reassembly->size = index * NETWORK_FRAGMENT_PAYLOAD_SIZE + payload_size;
+   }
+
+   u32 complete_mask = (count == 32) ? 0xFFFFFFFF : ((1u << count) - 1);
+   bool result = (reassembly->received_mask == complete_mask);
+
+   return(result);
+}
+
+static int begin_queue_push(network_queue *queue)
+{
+   // NOTE: Returns the entry index to fill, or -1 if the queue is full. The
+   // entry is handed over by end_queue_push.
+   int result = -1;
+
+   u32 read = ATOMIC_LOAD(&queue->read);
+   if(queue->write - read < NETWORK_QUEUE_SIZE)
+   {
+      result = queue->write % NETWORK_QUEUE_SIZE;
+   }
+
+   return(result);
+}
+
+static void end_queue_push(network_queue *queue)
+{
+   ATOMIC_STORE(&queue->write, queue->write + 1);
+}
+
+static int begin_queue_pop(network_queue *queue)
+{
+   // NOTE: Returns the index of the oldest entry, or -1 if the queue is empty.
+   // The entry is handed back by end_queue_pop.
+   int result = -1;
+
+   u32 write = ATOMIC_LOAD(&queue->write);
+   if(queue->read != write)
+   {
+      result = queue->read % NETWORK_QUEUE_SIZE;
+   }
+
+   return(result);
+}
+
+static void end_queue_pop(network_queue *queue)
+{
+   ATOMIC_STORE(&queue->read, queue->read + 1);
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+/* /////////////////////////////////////////////////////////////////////////// */
+/* (c) copyright 2024 Lawrence D. Kern /////////////////////////////////////// */
+/* /////////////////////////////////////////////////////////////////////////// */
+
+// NOTE: The server ticks at this rate, and clients place snapshots on their
+// own timeline using it.
+#define SERVER_TICK_RATE 60
+
+// NOTE: Clients send their input to the server as a plain game_packet, along
+// with the direction their camera faces and the tick of the newest snapshot
+// they have decoded. Each input is numbered, so the server can report which
+// one its authoritative position reflects.
+struct game_packet
+{
+   u64 client_id;
+   u32 input_sequence;
+   vec3 position;
+   vec3 view_direction;
+   u32 acked_tick;
+};
+
+struct server_player
+{
+   u64 client_id;
+   vec3 position;
+   vec3 view_direction;
+};
+
+#define SERVERPLAYER_COUNT_MAX 256
+
+// NOTE: Snapshots go out as a bit-packed stream, delta encoded against the
+// newest snapshot the client acknowledged. Players are named by a small network
+// index that stays fixed while they're connected, and positions are quantized
+// to NETWORK_POSITION_SCALE steps per unit.
+//
+// The stream starts with the tick, the age of the baseline in ticks (zero for
+// none), the recipient's network index, the sequence number of the recipient's
+// latest applied input and one more than the highest network index that
+// follows. The recipient's own position is included like any other player's.
+// Each index then has a changed bit. Changed indices have a present bit, and
+// present players their three position axes. An axis that was present in the
+// baseline has a small-delta bit, followed by either a zigzag encoded delta or
+// the full value. Axes new since the baseline are always sent in full.
+//
+// The server refreshes some positions less often than others, so every player
+// present in the snapshot, changed or not, ends with the age in ticks of its
+// position. Clients use it to find when each position was actually sampled.
+#define NETWORK_INDEX_BITS 8
+#define NETWORK_POSITION_BITS 20
+#define NETWORK_POSITION_SCALE 64.0f
+#define NETWORK_DELTA_BITS 8
+#define NETWORK_BASELINE_AGE_BITS 8
+#define NETWORK_SAMPLE_AGE_BITS 3
+
+// NOTE: Both sides keep this many recent snapshots to delta against, about
+// half a second at the server's tick rate.
+#define NETWORK_SNAPSHOT_HISTORY 32
+
+// NOTE: The largest possible snapshot sends every player in full.
+#define NETWORK_SNAPSHOT_BITS_MAX (64 + NETWORK_BASELINE_AGE_BITS + 2*NETWORK_INDEX_BITS + 1 + \
+                                   SERVERPLAYER_COUNT_MAX*(2 + 3*(1 + NETWORK_POSITION_BITS) + NETWORK_SAMPLE_AGE_BITS))
+#define NETWORK_SNAPSHOT_SIZE_MAX ((NETWORK_SNAPSHOT_BITS_MAX + 7) / 8)
+
+// NOTE: Snapshots too large for one datagram are split into fragments, each
+// small enough to cross any path without IP fragmentation. A fragment starts
+// with the snapshot's tick, its own index and the fragment count, followed by
+// its share of the encoded snapshot. Every fragment but the last is full.
+// Clients only decode a snapshot once all its fragments have arrived, so losing
+// any fragment loses the whole snapshot, the same as losing a datagram. The
+// next snapshot is still encoded against the last one the client acknowledged.
+#define NETWORK_FRAGMENT_HEADER_SIZE 6
+#define NETWORK_FRAGMENT_PAYLOAD_SIZE (SERVER_PACKET_SIZE - NETWORK_FRAGMENT_HEADER_SIZE)
+#define NETWORK_FRAGMENT_COUNT_MAX ((NETWORK_SNAPSHOT_SIZE_MAX + NETWORK_FRAGMENT_PAYLOAD_SIZE - 1) / NETWORK_FRAGMENT_PAYLOAD_SIZE)
+
+static_assert((1 << NETWORK_INDEX_BITS) >= SERVERPLAYER_COUNT_MAX, "Network indices can't name every player.");
+static_assert(NETWORK_SNAPSHOT_HISTORY < (1 << NETWORK_BASELINE_AGE_BITS), "Baseline ages don't fit their field.");
+static_assert((NETWORK_SNAPSHOT_HISTORY & (NETWORK_SNAPSHOT_HISTORY - 1)) == 0, "Snapshot history must be a power of two.");
+static_assert(NETWORK_FRAGMENT_COUNT_MAX <= 32, "Fragment masks don't cover every fragment.");
+
+struct network_datagram
+{
+   int size;
+   u8 data[SERVER_PACKET_SIZE];
+};
+
+// NOTE: The fragments of the newest snapshot being put back together. The
+// data must hold NETWORK_FRAGMENT_COUNT_MAX full payloads.
+struct network_reassembly
+{
+   u32 tick;
+   int fragment_count;
+   u32 received_mask;
+
+   int size;
+   u8 *data;
+};
+
+struct network_snapshot
+{
+   u32 tick;
+   u32 input_sequence;
+
+   u32 present[(SERVERPLAYER_COUNT_MAX + 31) / 32];
+   s32 positions[SERVERPLAYER_COUNT_MAX][3];
+
+   // NOTE: How many ticks before this snapshot each position was sampled,
+   // saturating at the largest age the stream can carry.
+   u8 sample_ages[SERVERPLAYER_COUNT_MAX];
+};
+
+// NOTE: Bits are packed least significant first. Writing past the capacity or
+// reading past the end sets overflowed instead of touching memory.
+struct bit_writer
+{
+   u8 *data;
+   int capacity;
+   int size;
+
+   u64 scratch;
+   int scratch_bits;
+   bool overflowed;
+};
+
+struct bit_reader
+{
+   u8 *data;
+   int size;
+   int position;
+
+   u64 scratch;
+   int scratch_bits;
+   bool overflowed;
+};
+
+// NOTE: A lock-free ring for handing messages from exactly one producer thread
+// to exactly one consumer thread. Only the producer advances write, and only the
+// consumer advances read, so entries in [read, write) belong to the consumer
+// and every other entry to the producer. The entries live in a separate array
+// of NETWORK_QUEUE_SIZE elements.
+#define NETWORK_QUEUE_SIZE 16
+static_assert((NETWORK_QUEUE_SIZE & (NETWORK_QUEUE_SIZE - 1)) == 0, "Network queue size must be a power of two.");
+
+struct network_queue
+{
+   u32 read;
+   u32 write;
+};
+
+// NOTE: A whole encoded snapshot, stamped with the platform clock when its
+// last fragment arrived.
+struct network_received_snapshot
+{
+   u64 received_microseconds;
+   int size;
+   u8 data[NETWORK_SNAPSHOT_SIZE_MAX];
+};
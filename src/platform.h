@@ -22,6 +22,46 @@
 // promises of being fast.
 #define PLATFORM_DEALLOCATE(name) void name(void *memory)
 
+// NOTE: Map the entire contents of a file into memory for reading, and write
+// its size in bytes to size. Returns 0 on failure. The memory must be treated
+// as read-only and stays valid until passed to the unmap function below.
+#define PLATFORM_MAP_FILE(name) void *name(const char *path, memsize *size)
+
+// NOTE: Release a file mapping returned by the map function above.
+#define PLATFORM_UNMAP_FILE(name) void name(void *memory, memsize size)
+
+// NOTE: Open a file for asynchronous reads, filling in its handle and size.
+// Returns false on failure.
+#define PLATFORM_OPEN_FILE(name) bool name(platform_file *file, const char *path)
+
+// NOTE: Close a file opened above. Any reads from it must have finished.
+#define PLATFORM_CLOSE_FILE(name) void name(platform_file *file)
+
+// NOTE: Return the time a file was last modified, or 0 if it can't be found.
+// The units are platform-specific, so only compare against earlier results.
+#define PLATFORM_GET_FILE_TIME(name) u64 name(const char *path)
+
+// NOTE: Start reading size bytes at offset from file into dest, without
+// waiting for the data. The caller fills in those fields and keeps the request
+// alive until its status is no longer pending. Reads should only be started
+// from the main thread, and any number may be in flight at once.
+#define PLATFORM_READ_FILE(name) void name(platform_read *read)
+
+// NOTE: Collect reads that have finished since the last call and update their
+// status. Never blocks. Reads are only guaranteed to make progress while this
+// is called regularly.
+#define PLATFORM_POLL_READS(name) void name(void)
+
+// NOTE: Run a callback on a pool of background threads. Work should only be
+// queued from the main thread. The pool is started on first use, and if the
+// queue is full the callback simply runs on the calling thread.
+typedef void platform_work_callback(void *data);
+#define PLATFORM_ENQUEUE_WORK(name) void name(platform_work_callback *callback, void *data)
+
+// NOTE: Block until all queued work has finished. The calling thread helps
+// drain the queue while it waits.
+#define PLATFORM_COMPLETE_ALL_WORK(name) void name(void)
+
 #define PLATFORM_INITIALIZE(name) void name(int width, int height)
 
 #define PLATFORM_FRAME_BEGIN(name) bool name(game_input *input)
@@ -35,6 +75,15 @@
 PLATFORM_LOG(platform_log);
 PLATFORM_ALLOCATE(platform_allocate);
 PLATFORM_DEALLOCATE(platform_deallocate);
+PLATFORM_MAP_FILE(platform_map_file);
+PLATFORM_UNMAP_FILE(platform_unmap_file);
+PLATFORM_OPEN_FILE(platform_open_file);
+PLATFORM_CLOSE_FILE(platform_close_file);
+PLATFORM_GET_FILE_TIME(platform_get_file_time);
+PLATFORM_READ_FILE(platform_read_file);
+PLATFORM_POLL_READS(platform_poll_reads);
+PLATFORM_ENQUEUE_WORK(platform_enqueue_work);
+PLATFORM_COMPLETE_ALL_WORK(platform_complete_all_work);
 
 PLATFORM_INITIALIZE(platform_initialize);
 PLATFORM_FRAME_BEGIN(platform_frame_begin);
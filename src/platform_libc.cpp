@@ -5,9 +5,16 @@
 #include "platform.h"
 
 #include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
 
-PLATFORM_LOG(plog)
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+PLATFORM_LOG(platform_log)
 {
    va_list arguments;
    va_start(arguments, fmt);
@@ -17,12 +24,185 @@ PLATFORM_LOG(plog)
    va_end(arguments);
 }
 
-PLATFORM_ALLOCATE(pallocate)
+PLATFORM_ALLOCATE(platform_allocate)
 {
    return calloc(1, size);
 }
 
-PLATFORM_DEALLOCATE(pdeallocate)
+PLATFORM_DEALLOCATE(platform_deallocate)
 {
    free(memory);
 }
+
+PLATFORM_MAP_FILE(platform_map_file)
+{
+   void *result = 0;
+
+   int file = open(path, O_RDONLY);
+   if(file >= 0)
+   {
+      struct stat info;
+      if(fstat(file, &info) == 0 && info.st_size > 0)
+      {
+         void *memory = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+         if(memory != MAP_FAILED)
+         {
+            result = memory;
+            *size = info.st_size;
+         }
+      }
+
+      // NOTE: The mapping stays valid after the descriptor is closed.
+      close(file);
+   }
+
+   return(result);
+}
+
+PLATFORM_UNMAP_FILE(platform_unmap_file)
+{
+   munmap(memory, size);
+}
+
+#define WORK_QUEUE_SIZE 256
+#define WORK_THREAD_COUNT_MAX 16
+
+struct libc_work_entry
+{
+   platform_work_callback *callback;
+   void *data;
+};
+
+static struct
+{
+   bool initialized;
+
+   pthread_mutex_t mutex;
+   pthread_cond_t work_available;
+   pthread_cond_t work_finished;
+
+   // NOTE: Entries in [read, write) are waiting to run. Pending also counts
+   // entries that have been taken but not yet finished.
+   u32 read;
+   u32 write;
+   u32 pending;
+   libc_work_entry entries[WORK_QUEUE_SIZE];
+} libc_work;
+
+static bool libc_take_work(libc_work_entry *entry)
+{
+   // NOTE: The caller holds the mutex.
+   bool result = (libc_work.read != libc_work.write);
+   if(result)
+   {
+      *entry = libc_work.entries[libc_work.read++ % WORK_QUEUE_SIZE];
+   }
+
+   return(result);
+}
+
+static void libc_finish_work(libc_work_entry entry)
+{
+   entry.callback(entry.data);
+
+   pthread_mutex_lock(&libc_work.mutex);
+   if(--libc_work.pending == 0)
+   {
+      pthread_cond_broadcast(&libc_work.work_finished);
+   }
+   pthread_mutex_unlock(&libc_work.mutex);
+}
+
+static void *libc_work_thread(void *parameter)
+{
+   for(;;)
+   {
+      libc_work_entry entry;
+
+      pthread_mutex_lock(&libc_work.mutex);
+      while(!libc_take_work(&entry))
+      {
+         pthread_cond_wait(&libc_work.work_available, &libc_work.mutex);
+      }
+      pthread_mutex_unlock(&libc_work.mutex);
+
+      libc_finish_work(entry);
+   }
+
+   return(0);
+}
+
+static void libc_initialize_work(void)
+{
+   pthread_mutex_init(&libc_work.mutex, 0);
+   pthread_cond_init(&libc_work.work_available, 0);
+   pthread_cond_init(&libc_work.work_finished, 0);
+
+   // NOTE: Leave one core for the main thread, which also helps drain the
+   // queue while waiting.
+   long core_count = sysconf(_SC_NPROCESSORS_ONLN);
+   int thread_count = (int)MINIMUM(MAXIMUM(core_count - 1, 1), WORK_THREAD_COUNT_MAX);
+   for(int index = 0; index < thread_count; ++index)
+   {
+      pthread_t thread;
+      if(pthread_create(&thread, 0, libc_work_thread, 0) == 0)
+      {
+         pthread_detach(thread);
+      }
+   }
+
+   libc_work.initialized = true;
+}
+
+PLATFORM_ENQUEUE_WORK(platform_enqueue_work)
+{
+   if(!libc_work.initialized)
+   {
+      libc_initialize_work();
+   }
+
+   pthread_mutex_lock(&libc_work.mutex);
+   bool queued = (libc_work.write - libc_work.read < WORK_QUEUE_SIZE);
+   if(queued)
+   {
+      libc_work_entry *entry = libc_work.entries + (libc_work.write++ % WORK_QUEUE_SIZE);
+      entry->callback = callback;
+      entry->data = data;
+      libc_work.pending++;
+
+      pthread_cond_signal(&libc_work.work_available);
+   }
+   pthread_mutex_unlock(&libc_work.mutex);
+
+   if(!queued)
+   {
+      callback(data);
+   }
+}
+
+PLATFORM_COMPLETE_ALL_WORK(platform_complete_all_work)
+{
+   if(!libc_work.initialized)
+   {
+      return;
+   }
+
+   pthread_mutex_lock(&libc_work.mutex);
+   while(libc_work.pending > 0)
+   {
+      libc_work_entry entry;
+      if(libc_take_work(&entry))
+      {
+         pthread_mutex_unlock(&libc_work.mutex);
+         libc_finish_work(entry);
+         pthread_mutex_lock(&libc_work.mutex);
+      }
+      else
+      {
+         pthread_cond_wait(&libc_work.work_finished, &libc_work.mutex);
+      }
+   }
+   pthread_mutex_unlock(&libc_work.mutex);
+}
+
+#include "platform_posix_io.cpp"
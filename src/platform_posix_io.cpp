@@ -0,0 +1,315 @@
+/* /////////////////////////////////////////////////////////////////////////// */
+/* (c) copyright 2024 Lawrence D. Kern /////////////////////////////////////// */
+/* /////////////////////////////////////////////////////////////////////////// */
+
+// NOTE: Asynchronous file reads shared by the POSIX platform layers, which
+// include this file after defining their work queue. On Linux reads are
+// submitted to an io_uring instance driven through the raw system calls, so
+// no extra library is needed. Without io_uring, or whenever the ring is full
+// or refuses a request, the read runs as a blocking pread on the work queue.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#   include <linux/io_uring.h>
+#   include <sys/mman.h>
+#   include <sys/syscall.h>
+#   define POSIX_USE_IO_URING 1
+#else
+#   define POSIX_USE_IO_URING 0
+#endif
+
+// NOTE: Single reads are split into pieces no larger than this, since both
+// io_uring and pread take 32-bit lengths in places.
+#define POSIX_READ_SIZE_MAX (1u << 30)
+
+static void posix_read_work(void *data)
+{
+   platform_read *read = (platform_read *)data;
+
+   u32 status = PLATFORMREAD_COMPLETE;
+   while(read->transferred < read->size)
+   {
+      u64 size = MINIMUM(read->size - read->transferred, POSIX_READ_SIZE_MAX);
+      ssize_t count = pread((int)read->file.handle, (u8 *)read->dest + read->transferred, size, read->offset + read->transferred);
+      if(count < 0 && errno == EINTR)
+      {
+         continue;
+      }
+
+      // NOTE: Hitting the end of the file early counts as a failure.
+      if(count <= 0)
+      {
+         status = PLATFORMREAD_FAILED;
+         break;
+      }
+
+      read->transferred += count;
+   }
+
+   ATOMIC_STORE(&read->status, status);
+}
+
+#if POSIX_USE_IO_URING
+#define IO_RING_ENTRY_COUNT 64
+
+static struct
+{
+   bool initialized;
+   bool available;
+
+   int descriptor;
+   u32 in_flight;
+   u32 entry_count;
+
+   u32 *sq_head;
+   u32 *sq_tail;
+   u32 *sq_mask;
+   u32 *sq_array;
+   io_uring_sqe *sqes;
+
+   u32 *cq_head;
+   u32 *cq_tail;
+   u32 *cq_mask;
+   io_uring_cqe *cqes;
+} posix_ring;
+
+static void posix_initialize_ring(void)
+{
+   posix_ring.initialized = true;
+
+   io_uring_params params = {};
+   int descriptor = (int)syscall(__NR_io_uring_setup, IO_RING_ENTRY_COUNT, &params);
+   if(descriptor < 0)
+   {
+      return;
+   }
+
+   // NOTE: IORING_OP_READ arrived in the same kernel release as this feature
+   // flag, so use it to skip rings that would reject every request.
+   if(!(params.features & IORING_FEAT_RW_CUR_POS))
+   {
+      close(descriptor);
+      return;
+   }
+
+   size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+   size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+   size_t sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+   // NOTE: Newer kernels share a single mapping between both rings.
+   bool single_mapping = (params.features & IORING_FEAT_SINGLE_MMAP);
+   if(single_mapping)
+   {
+      sq_size = MAXIMUM(sq_size, cq_size);
+      cq_size = sq_size;
+   }
+
+   int protection = PROT_READ|PROT_WRITE;
+   int flags = MAP_SHARED|MAP_POPULATE;
+   u8 *sq = (u8 *)mmap(0, sq_size, protection, flags, descriptor, IORING_OFF_SQ_RING);
+   u8 *cq = single_mapping ? sq : (u8 *)mmap(0, cq_size, protection, flags, descriptor, IORING_OFF_CQ_RING);
+   void *sqes = mmap(0, sqes_size, protection, flags, descriptor, IORING_OFF_SQES);
+   if(sq == MAP_FAILED || cq == MAP_FAILED || sqes == MAP_FAILED)
+   {
+      if(sq != MAP_FAILED) munmap(sq, sq_size);
+      if(cq != MAP_FAILED && !single_mapping) munmap(cq, cq_size);
+      if(sqes != MAP_FAILED) munmap(sqes, sqes_size);
+      close(descriptor);
+      return;
+   }
+
+   posix_ring.descriptor = descriptor;
+   posix_ring.entry_count = params.sq_entries;
+
+   posix_ring.sq_head = (u32 *)(sq + params.sq_off.head);
+   posix_ring.sq_tail = (u32 *)(sq + params.sq_off.tail);
+   posix_ring.sq_mask = (u32 *)(sq + params.sq_off.ring_mask);
+   posix_ring.sq_array = (u32 *)(sq + params.sq_off.array);
+   posix_ring.sqes = (io_uring_sqe *)sqes;
+
+   posix_ring.cq_head = (u32 *)(cq + params.cq_off.head);
+   posix_ring.cq_tail = (u32 *)(cq + params.cq_off.tail);
+   posix_ring.cq_mask = (u32 *)(cq + params.cq_off.ring_mask);
+   posix_ring.cqes = (io_uring_cqe *)(cq + params.cq_off.cqes);
+
+   posix_ring.available = true;
+}
+
+static bool posix_submit_read(platform_read *read)
+{
+   // NOTE: Keeping no more reads in flight than there are submission entries
+   // also guarantees the larger completion ring can never overflow.
+   if(posix_ring.in_flight >= posix_ring.entry_count)
+   {
+      return(false);
+   }
+
+   // NOTE: Only this thread writes the tail, and without SQPOLL the kernel only
+   // consumes entries inside io_uring_enter, so every slot is free here.
+   u32 tail = *posix_ring.sq_tail;
+   u32 index = tail & *posix_ring.sq_mask;
+
+   io_uring_sqe *sqe = posix_ring.sqes + index;
+   memset(sqe, 0, sizeof(*sqe));
+   sqe->opcode = IORING_OP_READ;
+   sqe->fd = (int)read->file.handle;
+   sqe->addr = (u64)((u8 *)read->dest + read->transferred);
+   sqe->len = (u32)MINIMUM(read->size - read->transferred, POSIX_READ_SIZE_MAX);
+   sqe->off = read->offset + read->transferred;
+   sqe->user_data = (u64)read;
+
+   posix_ring.sq_array[index] = index;
+   ATOMIC_STORE(posix_ring.sq_tail, tail + 1);
+
+   long submitted = syscall(__NR_io_uring_enter, posix_ring.descriptor, 1, 0, 0, 0, 0);
+   if(submitted != 1)
+   {
+      // NOTE: Nothing was consumed, so the entry can be taken back.
+      ATOMIC_STORE(posix_ring.sq_tail, tail);
+      return(false);
+   }
+
+   posix_ring.in_flight++;
+   return(true);
+}
+#endif
+
+static void posix_start_read(platform_read *read)
+{
+#if POSIX_USE_IO_URING
+   if(!posix_ring.initialized)
+   {
+      posix_initialize_ring();
+   }
+
+   if(posix_ring.available && posix_submit_read(read))
+   {
+      return;
+   }
+#endif
+
+   platform_enqueue_work(posix_read_work, read);
+}
+
+PLATFORM_OPEN_FILE(platform_open_file)
+{
+   bool result = false;
+
+   int handle = open(path, O_RDONLY|O_CLOEXEC);
+   if(handle >= 0)
+   {
+      struct stat info;
+      if(fstat(handle, &info) == 0)
+      {
+         file->handle = handle;
+         file->size = info.st_size;
+         result = true;
+      }
+      else
+      {
+         close(handle);
+      }
+   }
+
+   return(result);
+}
+
+PLATFORM_CLOSE_FILE(platform_close_file)
+{
+   if(file->handle >= 0)
+   {
+      close((int)file->handle);
+   }
+
+   file->handle = -1;
+   file->size = 0;
+}
+
+PLATFORM_GET_FILE_TIME(platform_get_file_time)
+{
+   u64 result = 0;
+
+   struct stat info;
+   if(stat(path, &info) == 0)
+   {
+      result = (u64)info.st_mtime * 1000000000ull;
+#if defined(__APPLE__)
+      result += info.st_mtimespec.tv_nsec;
+#else
+      result += info.st_mtim.tv_nsec;
+#endif
+   }
+
+   return(result);
+}
+
+PLATFORM_READ_FILE(platform_read_file)
+{
+   read->status = PLATFORMREAD_PENDING;
+   read->transferred = 0;
+
+   if(read->size == 0)
+   {
+      read->status = PLATFORMREAD_COMPLETE;
+   }
+   else
+   {
+      posix_start_read(read);
+   }
+}
+
+PLATFORM_POLL_READS(platform_poll_reads)
+{
+#if POSIX_USE_IO_URING
+   // NOTE: Reads on the work queue update their own status, so only ring
+   // completions need collecting.
+   if(!posix_ring.available)
+   {
+      return;
+   }
+
+   u32 head = *posix_ring.cq_head;
+   u32 tail = ATOMIC_LOAD(posix_ring.cq_tail);
+   for(; head != tail; ++head)
+   {
+      io_uring_cqe *cqe = posix_ring.cqes + (head & *posix_ring.cq_mask);
+      platform_read *read = (platform_read *)cqe->user_data;
+      int result = cqe->res;
+      posix_ring.in_flight--;
+
+      if(result > 0)
+      {
+         // NOTE: Short reads continue from where they stopped.
+         read->transferred += result;
+         if(read->transferred < read->size)
+         {
+            posix_start_read(read);
+         }
+         else
+         {
+            ATOMIC_STORE(&read->status, (u32)PLATFORMREAD_COMPLETE);
+         }
+      }
+      else if(result == -EINTR || result == -EAGAIN)
+      {
+         posix_start_read(read);
+      }
+      else if(result == -EINVAL || result == -EOPNOTSUPP)
+      {
+         // NOTE: The kernel or file system does not support this request.
+         platform_enqueue_work(posix_read_work, read);
+      }
+      else
+      {
+         ATOMIC_STORE(&read->status, (u32)PLATFORMREAD_FAILED);
+      }
+   }
+
+   ATOMIC_STORE(posix_ring.cq_head, head);
+#endif
+}
@@ -5,6 +5,20 @@
 #include "SDL3/SDL.h"
 #include "platform.h"
 
+#if NETWORKING_SUPPORTED
+#   include "network.cpp"
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#   define SDL_USE_POSIX 1
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#else
+#   define SDL_USE_POSIX 0
+#endif
+
 PLATFORM_LOG(platform_log)
 {
    va_list arguments;
@@ -25,6 +39,286 @@ PLATFORM_DEALLOCATE(platform_deallocate)
    SDL_free(memory);
 }
 
+PLATFORM_MAP_FILE(platform_map_file)
+{
+   void *result = 0;
+
+#if SDL_USE_POSIX
+   int file = open(path, O_RDONLY);
+   if(file >= 0)
+   {
+      struct stat info;
+      if(fstat(file, &info) == 0 && info.st_size > 0)
+      {
+         void *memory = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+         if(memory != MAP_FAILED)
+         {
+            result = memory;
+            *size = info.st_size;
+         }
+      }
+
+      // NOTE: The mapping stays valid after the descriptor is closed.
+      close(file);
+   }
+#else
+   // NOTE: Without a memory mapping API, fall back to reading the whole file.
+   size_t loaded_size = 0;
+   result = SDL_LoadFile(path, &loaded_size);
+   if(result)
+   {
+      *size = (memsize)loaded_size;
+   }
+#endif
+
+   if(!result)
+   {
+      platform_log("ERROR: Failed to map file %s.\n", path);
+   }
+
+   return(result);
+}
+
+PLATFORM_UNMAP_FILE(platform_unmap_file)
+{
+#if SDL_USE_POSIX
+   munmap(memory, size);
+#else
+   SDL_free(memory);
+#endif
+}
+
+#define WORK_QUEUE_SIZE 256
+#define WORK_THREAD_COUNT_MAX 16
+
+struct sdl_work_entry
+{
+   platform_work_callback *callback;
+   void *data;
+};
+
+static struct
+{
+   bool initialized;
+
+   SDL_Mutex *mutex;
+   SDL_Condition *work_available;
+   SDL_Condition *work_finished;
+
+   // NOTE: Entries in [read, write) are waiting to run. Pending also counts
+   // entries that have been taken but not yet finished.
+   u32 read;
+   u32 write;
+   u32 pending;
+   sdl_work_entry entries[WORK_QUEUE_SIZE];
+} sdl_work;
+
+static bool sdl_take_work(sdl_work_entry *entry)
+{
+   // NOTE: The caller holds the mutex.
+   bool result = (sdl_work.read != sdl_work.write);
+   if(result)
+   {
+      *entry = sdl_work.entries[sdl_work.read++ % WORK_QUEUE_SIZE];
+   }
+
+   return(result);
+}
+
+static void sdl_finish_work(sdl_work_entry entry)
+{
+   entry.callback(entry.data);
+
+   SDL_LockMutex(sdl_work.mutex);
+   if(--sdl_work.pending == 0)
+   {
+      SDL_BroadcastCondition(sdl_work.work_finished);
+   }
+   SDL_UnlockMutex(sdl_work.mutex);
+}
+
+static int sdl_work_thread(void *parameter)
+{
+   for(;;)
+   {
+      sdl_work_entry entry;
+
+      SDL_LockMutex(sdl_work.mutex);
+      while(!sdl_take_work(&entry))
+      {
+         SDL_WaitCondition(sdl_work.work_available, sdl_work.mutex);
+      }
+      SDL_UnlockMutex(sdl_work.mutex);
+
+      sdl_finish_work(entry);
+   }
+
+   return(0);
+}
+
+static void sdl_initialize_work(void)
+{
+   sdl_work.mutex = SDL_CreateMutex();
+   sdl_work.work_available = SDL_CreateCondition();
+   sdl_work.work_finished = SDL_CreateCondition();
+
+   // NOTE: Leave one core for the main thread, which also helps drain the
+   // queue while waiting.
+   int core_count = SDL_GetNumLogicalCPUCores();
+   int thread_count = MINIMUM(MAXIMUM(core_count - 1, 1), WORK_THREAD_COUNT_MAX);
+   for(int index = 0; index < thread_count; ++index)
+   {
+      SDL_Thread *thread = SDL_CreateThread(sdl_work_thread, "work", 0);
+      if(thread)
+      {
+         SDL_DetachThread(thread);
+      }
+   }
+
+   sdl_work.initialized = true;
+}
+
+PLATFORM_ENQUEUE_WORK(platform_enqueue_work)
+{
+   if(!sdl_work.initialized)
+   {
+      sdl_initialize_work();
+   }
+
+   SDL_LockMutex(sdl_work.mutex);
+   bool queued = (sdl_work.write - sdl_work.read < WORK_QUEUE_SIZE);
+   if(queued)
+   {
+      sdl_work_entry *entry = sdl_work.entries + (sdl_work.write++ % WORK_QUEUE_SIZE);
+      entry->callback = callback;
+      entry->data = data;
+      sdl_work.pending++;
+
+      SDL_SignalCondition(sdl_work.work_available);
+   }
+   SDL_UnlockMutex(sdl_work.mutex);
+
+   if(!queued)
+   {
+      callback(data);
+   }
+}
+
+PLATFORM_COMPLETE_ALL_WORK(platform_complete_all_work)
+{
+   if(!sdl_work.initialized)
+   {
+      return;
+   }
+
+   SDL_LockMutex(sdl_work.mutex);
+   while(sdl_work.pending > 0)
+   {
+      sdl_work_entry entry;
+      if(sdl_take_work(&entry))
+      {
+         SDL_UnlockMutex(sdl_work.mutex);
+         sdl_finish_work(entry);
+         SDL_LockMutex(sdl_work.mutex);
+      }
+      else
+      {
+         SDL_WaitCondition(sdl_work.work_finished, sdl_work.mutex);
+      }
+   }
+   SDL_UnlockMutex(sdl_work.mutex);
+}
+
+#if SDL_USE_POSIX
+#include "platform_posix_io.cpp"
+#else
+// NOTE: Without POSIX file descriptors, each read runs as a blocking read on
+// the work queue. SDL streams keep a file position, so reads from the same
+// file are serialized.
+static SDL_Mutex *sdl_file_mutex;
+
+static void sdl_read_work(void *data)
+{
+   platform_read *read = (platform_read *)data;
+   SDL_IOStream *stream = (SDL_IOStream *)(intptr_t)read->file.handle;
+
+   SDL_LockMutex(sdl_file_mutex);
+   if(SDL_SeekIO(stream, (Sint64)read->offset, SDL_IO_SEEK_SET) >= 0)
+   {
+      read->transferred = SDL_ReadIO(stream, read->dest, read->size);
+   }
+   SDL_UnlockMutex(sdl_file_mutex);
+
+   u32 status = (read->transferred == read->size) ? PLATFORMREAD_COMPLETE : PLATFORMREAD_FAILED;
+   ATOMIC_STORE(&read->status, status);
+}
+
+PLATFORM_OPEN_FILE(platform_open_file)
+{
+   bool result = false;
+
+   if(!sdl_file_mutex)
+   {
+      sdl_file_mutex = SDL_CreateMutex();
+   }
+
+   SDL_IOStream *stream = SDL_IOFromFile(path, "rb");
+   if(stream)
+   {
+      Sint64 size = SDL_GetIOSize(stream);
+      if(size >= 0)
+      {
+         file->handle = (s64)(intptr_t)stream;
+         file->size = (u64)size;
+         result = true;
+      }
+      else
+      {
+         SDL_CloseIO(stream);
+      }
+   }
+
+   return(result);
+}
+
+PLATFORM_CLOSE_FILE(platform_close_file)
+{
+   if(file->handle)
+   {
+      SDL_CloseIO((SDL_IOStream *)(intptr_t)file->handle);
+   }
+
+   file->handle = 0;
+   file->size = 0;
+}
+
+PLATFORM_GET_FILE_TIME(platform_get_file_time)
+{
+   u64 result = 0;
+
+   SDL_PathInfo info;
+   if(SDL_GetPathInfo(path, &info))
+   {
+      result = (u64)info.modify_time;
+   }
+
+   return(result);
+}
+
+PLATFORM_READ_FILE(platform_read_file)
+{
+   read->status = PLATFORMREAD_PENDING;
+   read->transferred = 0;
+
+   platform_enqueue_work(sdl_read_work, read);
+}
+
+PLATFORM_POLL_READS(platform_poll_reads)
+{
+   // NOTE: Reads on the work queue update their own status.
+}
+#endif
+
 static struct {
    SDL_Window *window;
    SDL_Renderer *renderer;
@@ -33,9 +327,15 @@ static struct {
    SDL_DisplayMode display_mode;
 
 #if NETWORKING_SUPPORTED
+   // NOTE: Only the network thread touches the socket once it has started.
    UDPsocket socket;
+   SDLNet_SocketSet socket_set;
    IPaddress server_address;
-   UDPpacket *packet;
+   UDPpacket *send_packet;
+   UDPpacket *receive_packet;
+
+   bool network_started;
+   u8 reassembly_data[NETWORK_FRAGMENT_COUNT_MAX * NETWORK_FRAGMENT_PAYLOAD_SIZE];
 #endif
 
    u64 frequency;
@@ -118,13 +418,22 @@ PLATFORM_INITIALIZE(platform_initialize)
       assert(0);
    }
 
-   sdl.packet = SDLNet_AllocPacket(512);
-   if(!sdl.packet)
+   sdl.send_packet = SDLNet_AllocPacket(SERVER_PACKET_SIZE);
+   sdl.receive_packet = SDLNet_AllocPacket(SERVER_PACKET_SIZE);
+   if(!sdl.send_packet || !sdl.receive_packet)
    {
       platform_log("ERROR: Failed to allocate UDP packet. %s\n", SDLNet_GetError());
       SDLNet_Quit();
       assert(0);
    }
+
+   sdl.socket_set = SDLNet_AllocSocketSet(1);
+   if(!sdl.socket_set || SDLNet_UDP_AddSocket(sdl.socket_set, sdl.socket) == -1)
+   {
+      platform_log("ERROR: Failed to watch UDP socket. %s\n", SDLNet_GetError());
+      SDLNet_Quit();
+      assert(0);
+   }
 #endif
 }
 
@@ -210,10 +519,18 @@ static void sdl_process_button(game_button *button, bool pressed)
    button->transitioned = true;
 }
 
+static u64 sdl_get_microseconds(void)
+{
+   u64 result = SDL_GetTicksNS() / 1000;
+   return(result);
+}
+
 PLATFORM_FRAME_BEGIN(platform_frame_begin)
 {
    bool keep_running = true;
 
+   input->frame_microseconds = sdl_get_microseconds();
+
    SDL_Event event;
    while(SDL_PollEvent(&event))
    {
@@ -343,37 +660,90 @@ PLATFORM_RENDER(platform_render)
 #define ELAPSED_SECONDS(start, end, freq) ((float)((end) - (start)) / (float)(freq))
 
 #if NETWORKING_SUPPORTED
-static void sdl_exchange_packets(game_context *game)
-{
-   memsize packet_size = sizeof(game->packet);
-   SDL_memcpy(sdl.packet->data, (void *)&game->packet, packet_size);
+// NOTE: How long the network thread sleeps waiting for datagrams, which bounds
+// how long queued input waits to be sent.
+#define SDL_NETWORK_WAIT_MS 1
 
-   sdl.packet->len = packet_size;
-   sdl.packet->address.host = sdl.server_address.host;
-   sdl.packet->address.port = sdl.server_address.port;
+static int sdl_network_thread(void *parameter)
+{
+   // NOTE: Runs for the lifetime of the process, independent of the frame
+   // rate. The game only talks to this thread through its two queues.
+   game_context *game = (game_context *)parameter;
 
-   SDLNet_UDP_Send(sdl.socket, -1, sdl.packet);
+   network_reassembly reassembly = {};
+   reassembly.data = sdl.reassembly_data;
 
-   int packet_count = SDLNet_UDP_Recv(sdl.socket, sdl.packet);
-   if(packet_count == -1)
+   while(1)
    {
-      platform_log("ERROR: Client failed to receive packet. %s\n", SDLNet_GetError());
-   }
-   else if(packet_count == 1)
-   {
-      game->spacket = *(server_packet *)sdl.packet->data;
+      int index;
+      while((index = begin_queue_pop(&game->input_queue)) >= 0)
+      {
+         memsize packet_size = sizeof(game_packet);
+         SDL_memcpy(sdl.send_packet->data, game->queued_inputs + index, packet_size);
+         end_queue_pop(&game->input_queue);
+
+         sdl.send_packet->len = packet_size;
+         sdl.send_packet->address.host = sdl.server_address.host;
+         sdl.send_packet->address.port = sdl.server_address.port;
+
+         SDLNet_UDP_Send(sdl.socket, -1, sdl.send_packet);
+      }
+
+      if(SDLNet_CheckSockets(sdl.socket_set, SDL_NETWORK_WAIT_MS) <= 0)
+      {
+         continue;
+      }
+
+      int packet_count;
+      while((packet_count = SDLNet_UDP_Recv(sdl.socket, sdl.receive_packet)) == 1)
+      {
+         if(!receive_fragment(&reassembly, sdl.receive_packet->data, sdl.receive_packet->len))
+         {
+            continue;
+         }
+
+         // NOTE: If the game stops draining the queue, newer snapshots are
+         // dropped until it catches up.
+         int slot = begin_queue_push(&game->snapshot_queue);
+         if(slot >= 0)
+         {
+            network_received_snapshot *received = game->received_snapshots + slot;
+            received->received_microseconds = sdl_get_microseconds();
+            received->size = reassembly.size;
+            SDL_memcpy(received->data, reassembly.data, reassembly.size);
+
+            end_queue_push(&game->snapshot_queue);
+         }
+      }
+
+      if(packet_count == -1)
+      {
+         platform_log("ERROR: Client failed to receive packet. %s\n", SDLNet_GetError());
+      }
    }
+
+   return(0);
 }
 #endif
 
 PLATFORM_FRAME_END(platform_frame_end)
 {
 #if NETWORKING_SUPPORTED
-   // NOTE: Send this frame's game data to the server and store any response we
-   // get back.
-   if(game->send_packet)
+   // NOTE: Start the network thread once the game's queues exist. The thread
+   // is detached and exits with the process.
+   if(!sdl.network_started)
    {
-      sdl_exchange_packets(sdl, game);
+      sdl.network_started = true;
+
+      SDL_Thread *thread = SDL_CreateThread(sdl_network_thread, "network", game);
+      if(thread)
+      {
+         SDL_DetachThread(thread);
+      }
+      else
+      {
+         platform_log("ERROR: Failed to start the network thread. %s\n", SDL_GetError());
+      }
    }
 #endif
 
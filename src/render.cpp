@@ -18,10 +18,60 @@ static void push_clear(game_context *game, u32 color)
    command->color = color;
 }
 
+static u32 get_render_pipeline(render_triangle *triangle)
+{
+   u32 result = 0;
+   if(triangle->texture)
+   {
+      result |= RENDERPIPELINE(textured);
+      if(triangle->filter == TEXTUREFILTER_BILINEAR)
+      {
+         result |= RENDERPIPELINE(bilinear);
+      }
+
+      // NOTE: Modulating by white changes nothing, so skip it.
+      if(triangle->color != 0xFFFFFFFF)
+      {
+         result |= RENDERPIPELINE(modulated);
+      }
+   }
+
+   return(result);
+}
+
 static void push_triangle(game_context *game, int triangle_index)
 {
-   render_command *command = push_command(game, RENDERCOMMAND_TRIANGLE);
-   command->index = triangle_index;
+   u32 pipeline = get_render_pipeline(game->triangles + triangle_index);
+
+   // NOTE: Consecutive triangles that share a pipeline state extend the
+   // previous batch, so that state is only dispatched on once per batch.
+   if(game->render_command_count > 0)
+   {
+      render_command *previous = game->render_commands + (game->render_command_count - 1);
+      render_triangle_batch *batch = &previous->batch;
+      if(previous->kind == RENDERCOMMAND_TRIANGLES &&
+         batch->pipeline == pipeline &&
+         batch->triangle_index + batch->triangle_count == triangle_index)
+      {
+         batch->triangle_count++;
+         return;
+      }
+   }
+
+   render_command *command = push_command(game, RENDERCOMMAND_TRIANGLES);
+   command->batch.triangle_index = triangle_index;
+   command->batch.triangle_count = 1;
+   command->batch.pipeline = pipeline;
+}
+
+static void push_sprite(game_context *game, render_sprite sprite)
+{
+   assert(game->sprite_count < game->sprite_count_max);
+   int sprite_index = game->sprite_count++;
+   game->sprites[sprite_index] = sprite;
+
+   render_command *command = push_command(game, RENDERCOMMAND_SPRITE);
+   command->index = sprite_index;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -226,23 +276,580 @@ static void draw_filled_triangle(game_texture texture, vec2i v0, vec2i v1, vec2i
    }
 }
 
-static void draw_triangle(game_texture texture, render_triangle triangle)
+static u32 modulate_color(u32 a, u32 b)
 {
-#if 0
-   vec2 v0 = triangle.vertices[0].xy;
-   vec2 v1 = triangle.vertices[1].xy;
-   vec2 v2 = triangle.vertices[2].xy;
+   // NOTE: Multiply each 8-bit channel, treating 255 as one.
+   u32 result = 0;
+   for(int shift = 0; shift < 32; shift += 8)
+   {
+      u32 product = ((a >> shift) & 0xFF) * ((b >> shift) & 0xFF);
+      result |= ((product + 255) >> 8) << shift;
+   }
+
+   return(result);
+}
+
+static u32 blend_texels(u32 t00, u32 t10, u32 t01, u32 t11, u32 fx, u32 fy)
+{
+   // NOTE: The weights fx and fy are in 0.8 fixed point.
+   u32 result = 0;
+   for(int shift = 0; shift < 32; shift += 8)
+   {
+      u32 top = ((t00 >> shift) & 0xFF)*(256 - fx) + ((t10 >> shift) & 0xFF)*fx;
+      u32 bottom = ((t01 >> shift) & 0xFF)*(256 - fx) + ((t11 >> shift) & 0xFF)*fx;
+      result |= ((top*(256 - fy) + bottom*fy) >> 16) << shift;
+   }
+
+   return(result);
+}
+
+static int select_mip_level(mesh_asset_texture *texture, float rho_squared)
+{
+   // NOTE: rho is the length of the larger screen-space step across the quad,
+   // measured in level 0 texels. Each level halves it, so the nearest level is
+   // round(log2(rho)) = floor(log2(2*rho^2) / 2), which the float exponent of
+   // 2*rho^2 gives without a logarithm.
+   int result = 0;
+
+   int exponent;
+   frexpf(2.0f*rho_squared, &exponent);
+   if(exponent > 1)
+   {
+      result = MINIMUM((exponent - 1) / 2, texture->mip_count - 1);
+   }
+
+   return(result);
+}
+
+#define QUAD_LANE_COUNT 4
+
+template<u32 pipeline>
+static void sample_quad(u32 *texels, mesh_asset_texture *texture, int level, float *u, float *v, u32 covered_mask)
+{
+   // NOTE: Texture coordinates arrive in level 0 texels and wrap. Each lane
+   // works independently, so the loops below map onto vector lanes when the
+   // compiler allows.
+   int width_log2 = MAXIMUM(texture->width_log2 - level, 0);
+   int height_log2 = MAXIMUM(texture->height_log2 - level, 0);
+   int width_mask = (1 << width_log2) - 1;
+   int height_mask = (1 << height_log2) - 1;
+   float scale = 1.0f / (float)(1 << level);
+
+   u32 *mip = texture->mips[level];
+
+   if(pipeline & RENDERPIPELINE(bilinear))
+   {
+      for(int lane = 0; lane < QUAD_LANE_COUNT; ++lane)
+      {
+         if(covered_mask & (1 << lane))
+         {
+            float x = u[lane]*scale - 0.5f;
+            float y = v[lane]*scale - 0.5f;
+            float x_floor = floorf(x);
+            float y_floor = floorf(y);
+
+            u32 fx = (u32)((x - x_floor) * 256.0f);
+            u32 fy = (u32)((y - y_floor) * 256.0f);
+
+            int x0 = (int)x_floor & width_mask;
+            int y0 = (int)y_floor & height_mask;
+            int x1 = (x0 + 1) & width_mask;
+            int y1 = (y0 + 1) & height_mask;
+
+            u32 t00 = mip[morton_index(x0, y0, width_log2, height_log2)];
+            u32 t10 = mip[morton_index(x1, y0, width_log2, height_log2)];
+            u32 t01 = mip[morton_index(x0, y1, width_log2, height_log2)];
+            u32 t11 = mip[morton_index(x1, y1, width_log2, height_log2)];
+
+            texels[lane] = blend_texels(t00, t10, t01, t11, fx, fy);
+         }
+      }
+   }
+   else
+   {
+      for(int lane = 0; lane < QUAD_LANE_COUNT; ++lane)
+      {
+         if(covered_mask & (1 << lane))
+         {
+            int x = (int)floorf(u[lane]*scale) & width_mask;
+            int y = (int)floorf(v[lane]*scale) & height_mask;
+            texels[lane] = mip[morton_index(x, y, width_log2, height_log2)];
+         }
+      }
+   }
+}
+
+struct attribute_plane
+{
+   float origin;
+   float dx;
+   float dy;
+};
+
+static attribute_plane make_attribute_plane(vec2i v0, vec2i v1, vec2i v2, float a0, float a1, float a2, float inverse_area)
+{
+   // NOTE: Solve for the plane a(x, y) = origin + x*dx + y*dy that passes
+   // through the attribute's value at each vertex.
+   float x1 = (float)(v1.x - v0.x);
+   float y1 = (float)(v1.y - v0.y);
+   float x2 = (float)(v2.x - v0.x);
+   float y2 = (float)(v2.y - v0.y);
+
+   attribute_plane result;
+   result.dx = ((a1 - a0)*y2 - (a2 - a0)*y1) * inverse_area;
+   result.dy = ((a2 - a0)*x1 - (a1 - a0)*x2) * inverse_area;
+   result.origin = a0 - v0.x*result.dx - v0.y*result.dy;
+
+   return(result);
+}
+
+template<u32 pipeline>
+static void draw_textured_triangle(game_texture texture, render_triangle triangle)
+{
+   mesh_asset_texture *source = triangle.texture;
 
-   draw_line(texture, v0.x, v0.y, v1.x, v1.y, triangle.color);
-   draw_line(texture, v1.x, v1.y, v2.x, v2.y, triangle.color);
-   draw_line(texture, v2.x, v2.y, v0.x, v0.y, triangle.color);
-#else
    vec2i v0 = {(int)triangle.vertices[0].x, (int)triangle.vertices[0].y};
    vec2i v1 = {(int)triangle.vertices[1].x, (int)triangle.vertices[1].y};
    vec2i v2 = {(int)triangle.vertices[2].x, (int)triangle.vertices[2].y};
 
-   draw_filled_triangle(texture, v0, v1, v2, triangle.color);
+   // NOTE: As with flat triangles, only counter-clockwise triangles on screen
+   // cover any pixels.
+   int area = orient2d(v0, v1, v2);
+   if(area <= 0)
+   {
+      return;
+   }
+
+   // NOTE: 1/w, u/w and v/w vary linearly in screen space, so set up a plane
+   // for each once per triangle. Texture coordinates are scaled to level 0
+   // texels up front.
+   float inverse_area = 1.0f / (float)area;
+   float texture_width = (float)(1 << source->width_log2);
+   float texture_height = (float)(1 << source->height_log2);
+
+   float iw[3];
+   float uw[3];
+   float vw[3];
+   for(int vertex_index = 0; vertex_index < 3; ++vertex_index)
+   {
+      iw[vertex_index] = triangle.inverse_depths[vertex_index];
+      uw[vertex_index] = triangle.texcoords[vertex_index].u * texture_width * iw[vertex_index];
+      vw[vertex_index] = triangle.texcoords[vertex_index].v * texture_height * iw[vertex_index];
+   }
+
+   attribute_plane iw_plane = make_attribute_plane(v0, v1, v2, iw[0], iw[1], iw[2], inverse_area);
+   attribute_plane uw_plane = make_attribute_plane(v0, v1, v2, uw[0], uw[1], uw[2], inverse_area);
+   attribute_plane vw_plane = make_attribute_plane(v0, v1, v2, vw[0], vw[1], vw[2], inverse_area);
+
+   // NOTE: Compute the bounding box, clipped to the screen, then align it to
+   // whole 2x2 quads.
+   int xmin = MAXIMUM(MINIMUM(MINIMUM(v0.x, v1.x), v2.x), 0) & ~1;
+   int ymin = MAXIMUM(MINIMUM(MINIMUM(v0.y, v1.y), v2.y), 0) & ~1;
+
+   int xmax = MINIMUM(MAXIMUM(MAXIMUM(v0.x, v1.x), v2.x), texture.width - 1);
+   int ymax = MINIMUM(MAXIMUM(MAXIMUM(v0.y, v1.y), v2.y), texture.height - 1);
+
+   int bias0 = is_top_left(v1, v2) ? 0 : -1;
+   int bias1 = is_top_left(v2, v0) ? 0 : -1;
+   int bias2 = is_top_left(v0, v1) ? 0 : -1;
+
+   int a01 = v0.y - v1.y;
+   int b01 = v1.x - v0.x;
+
+   int a12 = v1.y - v2.y;
+   int b12 = v2.x - v1.x;
+
+   int a20 = v2.y - v0.y;
+   int b20 = v0.x - v2.x;
+
+   vec2i point = {xmin, ymin};
+   int w0_row = orient2d(v1, v2, point) + bias0;
+   int w1_row = orient2d(v2, v0, point) + bias1;
+   int w2_row = orient2d(v0, v1, point) + bias2;
+
+   // NOTE: Lanes are ordered top-left, top-right, bottom-left, bottom-right.
+   int lane_x[QUAD_LANE_COUNT] = {0, 1, 0, 1};
+   int lane_y[QUAD_LANE_COUNT] = {0, 0, 1, 1};
+
+   for(point.y = ymin; point.y <= ymax; point.y += 2)
+   {
+      int w0 = w0_row;
+      int w1 = w1_row;
+      int w2 = w2_row;
+
+      for(point.x = xmin; point.x <= xmax; point.x += 2)
+      {
+         u32 covered_mask = 0;
+         for(int lane = 0; lane < QUAD_LANE_COUNT; ++lane)
+         {
+            int lane_w0 = w0 + lane_x[lane]*a12 + lane_y[lane]*b12;
+            int lane_w1 = w1 + lane_x[lane]*a20 + lane_y[lane]*b20;
+            int lane_w2 = w2 + lane_x[lane]*a01 + lane_y[lane]*b01;
+
+            bool inside_box = (point.x + lane_x[lane] <= xmax && point.y + lane_y[lane] <= ymax);
+            if((lane_w0 | lane_w1 | lane_w2) >= 0 && inside_box)
+            {
+               covered_mask |= (1 << lane);
+            }
+         }
+
+         if(covered_mask)
+         {
+            // NOTE: Uncovered lanes are still interpolated, since the whole quad
+            // is needed for the screen-space derivatives.
+            float u[QUAD_LANE_COUNT];
+            float v[QUAD_LANE_COUNT];
+            for(int lane = 0; lane < QUAD_LANE_COUNT; ++lane)
+            {
+               float x = (float)(point.x + lane_x[lane]);
+               float y = (float)(point.y + lane_y[lane]);
+
+               float inverse_w = iw_plane.origin + x*iw_plane.dx + y*iw_plane.dy;
+               float w = 1.0f / MAXIMUM(inverse_w, 1e-6f);
+
+               u[lane] = (uw_plane.origin + x*uw_plane.dx + y*uw_plane.dy) * w;
+               v[lane] = (vw_plane.origin + x*vw_plane.dx + y*vw_plane.dy) * w;
+            }
+
+            float dudx = u[1] - u[0];
+            float dvdx = v[1] - v[0];
+            float dudy = u[2] - u[0];
+            float dvdy = v[2] - v[0];
+            float rho_squared = MAXIMUM(dudx*dudx + dvdx*dvdx, dudy*dudy + dvdy*dvdy);
+
+            int level = select_mip_level(source, rho_squared);
+
+            u32 texels[QUAD_LANE_COUNT];
+            sample_quad<pipeline>(texels, source, level, u, v, covered_mask);
+
+            for(int lane = 0; lane < QUAD_LANE_COUNT; ++lane)
+            {
+               if(covered_mask & (1 << lane))
+               {
+                  u32 color = texels[lane];
+                  if(pipeline & RENDERPIPELINE(modulated))
+                  {
+                     color = modulate_color(color, triangle.color);
+                  }
+
+                  int x = point.x + lane_x[lane];
+                  int y = point.y + lane_y[lane];
+                  texture.memory[texture.width*y + x] = color;
+               }
+            }
+         }
+
+         w0 += 2*a12;
+         w1 += 2*a20;
+         w2 += 2*a01;
+      }
+
+      w0_row += 2*b12;
+      w1_row += 2*b20;
+      w2_row += 2*b01;
+   }
+}
+
+#define DRAW_TRIANGLE_BATCH(name) void name(game_texture texture, render_triangle *triangles, int triangle_count)
+typedef DRAW_TRIANGLE_BATCH(draw_triangle_batch_function);
+
+template<u32 pipeline>
+static DRAW_TRIANGLE_BATCH(draw_triangle_batch)
+{
+   // NOTE: pipeline is a compile-time constant, so each instantiation keeps
+   // only the code for its own features.
+   for(int triangle_index = 0; triangle_index < triangle_count; ++triangle_index)
+   {
+      render_triangle *triangle = triangles + triangle_index;
+      if(pipeline & RENDERPIPELINE(textured))
+      {
+         draw_textured_triangle<pipeline>(texture, *triangle);
+      }
+      else
+      {
+#if 0
+         vec2 v0 = triangle->vertices[0].xy;
+         vec2 v1 = triangle->vertices[1].xy;
+         vec2 v2 = triangle->vertices[2].xy;
+
+         draw_line(texture, v0.x, v0.y, v1.x, v1.y, triangle->color);
+         draw_line(texture, v1.x, v1.y, v2.x, v2.y, triangle->color);
+         draw_line(texture, v2.x, v2.y, v0.x, v0.y, triangle->color);
+#else
+         vec2i v0 = {(int)triangle->vertices[0].x, (int)triangle->vertices[0].y};
+         vec2i v1 = {(int)triangle->vertices[1].x, (int)triangle->vertices[1].y};
+         vec2i v2 = {(int)triangle->vertices[2].x, (int)triangle->vertices[2].y};
+
+         draw_filled_triangle(texture, v0, v1, v2, triangle->color);
 #endif
+      }
+   }
+}
+
+// NOTE: Indexed by pipeline state. Combinations that can't occur, like
+// filtering without a texture, still get an entry so the index is never
+// checked. The table is generated from the pipeline count, so entry N is
+// always draw_triangle_batch<N>.
+template<u32... pipelines>
+struct pipeline_sequence
+{
+};
+
+template<u32 count, u32... pipelines>
+struct make_pipeline_sequence : make_pipeline_sequence<count - 1, count - 1, pipelines...>
+{
+};
+
+template<u32... pipelines>
+struct make_pipeline_sequence<0, pipelines...>
+{
+   typedef pipeline_sequence<pipelines...> type;
+};
+
+template<typename sequence>
+struct draw_triangle_batch_table;
+
+template<u32... pipelines>
+struct draw_triangle_batch_table<pipeline_sequence<pipelines...>>
+{
+   static draw_triangle_batch_function *entries[sizeof...(pipelines)];
+};
+
+template<u32... pipelines>
+draw_triangle_batch_function *draw_triangle_batch_table<pipeline_sequence<pipelines...>>::entries[sizeof...(pipelines)] =
+{
+   draw_triangle_batch<pipelines>...
+};
+
+static draw_triangle_batch_function **draw_triangle_batches =
+   draw_triangle_batch_table<make_pipeline_sequence<RENDERPIPELINE_COUNT>::type>::entries;
+
+static void draw_triangle(game_texture texture, render_triangle triangle)
+{
+   draw_triangle_batches[get_render_pipeline(&triangle)](texture, &triangle, 1);
+}
+
+static game_texture get_impostor_cell(game_texture atlas, int cell_index)
+{
+   // NOTE: Cells are stacked vertically, so each one is a contiguous texture.
+   game_texture result;
+   result.width = atlas.width;
+   result.height = atlas.width;
+   result.memory = atlas.memory + (atlas.width * atlas.width * cell_index);
+
+   return(result);
+}
+
+static void draw_sprite(game_texture texture, game_texture atlas, render_sprite sprite)
+{
+   game_texture cell = get_impostor_cell(atlas, sprite.cell_index);
+
+   int xmin = MAXIMUM(sprite.x, 0);
+   int ymin = MAXIMUM(sprite.y, 0);
+
+   int xmax = MINIMUM(sprite.x + sprite.size, texture.width);
+   int ymax = MINIMUM(sprite.y + sprite.size, texture.height);
+
+   // NOTE: Step through the cell in 16.16 fixed point, skipping texels that
+   // were left transparent by the bake.
+   int step = (cell.width << 16) / sprite.size;
+   int v = (ymin - sprite.y) * step;
+
+   for(int y = ymin; y < ymax; ++y)
+   {
+      u32 *src = cell.memory + cell.width*(v >> 16);
+      u32 *dst = texture.memory + texture.width*y;
+
+      int u = (xmin - sprite.x) * step;
+      for(int x = xmin; x < xmax; ++x)
+      {
+         u32 texel = src[u >> 16];
+         if(texel & 0xFF)
+         {
+            dst[x] = texel;
+         }
+         u += step;
+      }
+
+      v += step;
+   }
+}
+
+static vec3 get_impostor_direction(int yaw_index, int pitch_index)
+{
+   float yaw = (float)yaw_index / (float)IMPOSTOR_YAW_COUNT;
+   float pitch = pitch_index * IMPOSTOR_PITCH_STEP;
+
+   vec3 result = v3(cosine(yaw) * cosine(pitch),
+                    sine(yaw) * cosine(pitch),
+                    -sine(pitch));
+   return(result);
+}
+
+static int get_impostor_view(vec3 direction)
+{
+   // NOTE: direction points from the camera to the mesh, in mesh space.
+   float yaw = arctangent2(direction.y, direction.x);
+   float pitch = arctangent2(-direction.z, length(direction.xy));
+
+   int yaw_index = round_to_int(yaw * IMPOSTOR_YAW_COUNT);
+   yaw_index = ((yaw_index % IMPOSTOR_YAW_COUNT) + IMPOSTOR_YAW_COUNT) % IMPOSTOR_YAW_COUNT;
+
+   int pitch_index = round_to_int(pitch / IMPOSTOR_PITCH_STEP);
+   pitch_index = MINIMUM(MAXIMUM(pitch_index, 0), IMPOSTOR_PITCH_COUNT - 1);
+
+   int result = pitch_index*IMPOSTOR_YAW_COUNT + yaw_index;
+   return(result);
+}
+
+static vec3 get_vertex_position(mesh_asset *mesh, int vertex_index)
+{
+   vec3 result;
+   if(mesh->vertex_format == MESHVERTEX_PACKED)
+   {
+      mesh_asset_packed_vertex *vertex = mesh->packed_vertices + vertex_index;
+      result.x = mesh->position_offset.x + vertex->position[0]*mesh->position_scale.x;
+      result.y = mesh->position_offset.y + vertex->position[1]*mesh->position_scale.y;
+      result.z = mesh->position_offset.z + vertex->position[2]*mesh->position_scale.z;
+   }
+   else
+   {
+      result = mesh->vertices[vertex_index].position;
+   }
+
+   return(result);
+}
+
+static vec2 get_vertex_texcoord(mesh_asset *mesh, int vertex_index)
+{
+   vec2 result;
+   if(mesh->vertex_format == MESHVERTEX_PACKED)
+   {
+      mesh_asset_packed_vertex *vertex = mesh->packed_vertices + vertex_index;
+      result.u = mesh->texcoord_offset.u + vertex->texcoord[0]*mesh->texcoord_scale.u;
+      result.v = mesh->texcoord_offset.v + vertex->texcoord[1]*mesh->texcoord_scale.v;
+   }
+   else
+   {
+      result = mesh->vertices[vertex_index].texcoord;
+   }
+
+   return(result);
+}
+
+static vec3 get_vertex_normal(mesh_asset *mesh, int vertex_index)
+{
+   vec3 result;
+   if(mesh->vertex_format == MESHVERTEX_PACKED)
+   {
+      // NOTE: Unfold the octahedron. Normals in the lower hemisphere were
+      // folded over the diagonals when encoded.
+      mesh_asset_packed_vertex *vertex = mesh->packed_vertices + vertex_index;
+      float x = vertex->normal[0] / 32767.0f;
+      float y = vertex->normal[1] / 32767.0f;
+      float z = 1.0f - absolute_value(x) - absolute_value(y);
+      if(z < 0.0f)
+      {
+         float folded_x = (1.0f - absolute_value(y)) * (x < 0.0f ? -1.0f : 1.0f);
+         float folded_y = (1.0f - absolute_value(x)) * (y < 0.0f ? -1.0f : 1.0f);
+         x = folded_x;
+         y = folded_y;
+      }
+      result = normalize(v3(x, y, z));
+   }
+   else
+   {
+      result = mesh->vertices[vertex_index].normal;
+   }
+
+   return(result);
+}
+
+static int get_placeholder_cell_index(game_context *game)
+{
+   int result = game->mesh_count * IMPOSTOR_VIEW_COUNT;
+   return(result);
+}
+
+static bool initialize_impostor_atlas(game_context *game)
+{
+   int cell_count = game->mesh_count*IMPOSTOR_VIEW_COUNT + 1;
+
+   game_texture *atlas = &game->impostor_atlas;
+   atlas->width = IMPOSTOR_SIZE;
+   atlas->height = IMPOSTOR_SIZE * cell_count;
+   atlas->memory = arena_array(&game->perma, u32, atlas->width*atlas->height);
+   if(!atlas->memory)
+   {
+      platform_log("ERROR: Failed to allocate the impostor atlas.\n");
+      return(false);
+   }
+
+   // NOTE: The placeholder stands in for meshes that haven't been streamed in
+   // yet. It is a plain disc filling the bounding sphere.
+   game_texture placeholder = get_impostor_cell(*atlas, get_placeholder_cell_index(game));
+   float half_size = 0.5f * IMPOSTOR_SIZE;
+   for(int y = 0; y < placeholder.height; ++y)
+   {
+      for(int x = 0; x < placeholder.width; ++x)
+      {
+         float dx = (x + 0.5f) - half_size;
+         float dy = (y + 0.5f) - half_size;
+         bool inside = (dx*dx + dy*dy <= half_size*half_size);
+         placeholder.memory[y*placeholder.width + x] = (inside) ? 0x777777FF : 0x00000000;
+      }
+   }
+
+   return(true);
+}
+
+static void bake_mesh_impostors(game_context *game, int mesh_index)
+{
+   game_texture *atlas = &game->impostor_atlas;
+   mesh_asset *mesh = game->meshes + mesh_index;
+
+   // NOTE: Fit the bounding sphere to the cell.
+   float half_size = 0.5f * IMPOSTOR_SIZE;
+   float scale = (mesh->radius > 0.0f) ? (half_size / mesh->radius) : 0.0f;
+
+   for(int view_index = 0; view_index < IMPOSTOR_VIEW_COUNT; ++view_index)
+   {
+      game_texture cell = get_impostor_cell(*atlas, mesh_index*IMPOSTOR_VIEW_COUNT + view_index);
+      clear(cell, 0x00000000);
+
+      // NOTE: Build an orthographic camera that matches the game camera's
+      // conventions, with -y as right and z as up.
+      vec3 forward = get_impostor_direction(view_index % IMPOSTOR_YAW_COUNT, view_index / IMPOSTOR_YAW_COUNT);
+      vec3 right = normalize(cross(forward, v3(0, 0, 1)));
+      vec3 up = cross(right, forward);
+
+      for(int face_index = 0; face_index < mesh->face_count; ++face_index)
+      {
+         mesh_asset_face face = mesh->faces[face_index];
+
+         // NOTE: The projection is orthographic, so every corner has the same
+         // depth and texture coordinates interpolate affinely.
+         render_triangle triangle = {};
+         triangle.color = face.color;
+         triangle.filter = TEXTUREFILTER_BILINEAR;
+         if(face.texture_index >= 0)
+         {
+            triangle.texture = mesh->textures + face.texture_index;
+         }
+
+         for(int vertex_index = 0; vertex_index < 3; ++vertex_index)
+         {
+            int mesh_vertex_index = face.vertex_indices[vertex_index];
+            vec3 vertex = get_vertex_position(mesh, mesh_vertex_index);
+            triangle.vertices[vertex_index].x = half_size + dot(vertex, right)*scale;
+            triangle.vertices[vertex_index].y = half_size - dot(vertex, up)*scale;
+            triangle.texcoords[vertex_index] = get_vertex_texcoord(mesh, mesh_vertex_index);
+            triangle.inverse_depths[vertex_index] = 1.0f;
+         }
+
+         draw_triangle(cell, triangle);
+      }
+   }
 }
 
 static void draw_debug_triangles(game_context *game)
@@ -255,6 +862,7 @@ static void draw_debug_triangles(game_context *game)
 
       render_triangle *triangle = game->triangles + triangle_index;
       triangle->color = 0x00FF00FF;
+      triangle->texture = 0;
 
       vec2i origin = {30, 30};
       int half_dim = 20;
@@ -306,25 +914,81 @@ void initialize_frustum_planes(float aspect_width_over_height, float fov, float
    gfrustum_planes[FRUSTUMPLANE_FAR].normal = v3(-1, 0, 0);
 }
 
-render_polygon make_polygon(mesh_asset *mesh, int face_index)
+static bool sphere_outside_frustum(vec3 center, float radius)
 {
-   mesh_asset_face face = mesh->faces[face_index];
+   // NOTE: The center is given in camera space, like the frustum planes.
+   bool result = false;
+   for(int plane_index = 0; plane_index < FRUSTUMPLANE_COUNT; ++plane_index)
+   {
+      plane *p = gfrustum_planes + plane_index;
+      if(dot(center - p->point, p->normal) < -radius)
+      {
+         result = true;
+         break;
+      }
+   }
+
+   return(result);
+}
 
+static void transform_vertices(vec3 *positions, mesh_asset *mesh, int vertex_offset, int vertex_count, mat4 transform)
+{
+   // NOTE: Transform a whole vertex range up front, so that vertices shared by
+   // several faces are only transformed once.
+   if(mesh->vertex_format == MESHVERTEX_PACKED)
+   {
+      // NOTE: Fold dequantization into the transform, so each packed position
+      // only needs converting to float before the usual multiply.
+      vec3 offset = mesh->position_offset;
+      vec3 scale = mesh->position_scale;
+      transform = transform * make_translation(offset.x, offset.y, offset.z) * make_scale(scale.x, scale.y, scale.z);
+
+      mesh_asset_packed_vertex *vertices = mesh->packed_vertices + vertex_offset;
+      for(int vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+      {
+         u16 *p = vertices[vertex_index].position;
+         positions[vertex_index] = transform * v3(p[0], p[1], p[2]);
+      }
+   }
+   else
+   {
+      mesh_asset_vertex *vertices = mesh->vertices + vertex_offset;
+      for(int vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+      {
+         positions[vertex_index] = transform * vertices[vertex_index].position;
+      }
+   }
+}
+
+render_polygon make_polygon(mesh_asset *mesh, int vertex_offset, vec3 *positions, mesh_asset_face face)
+{
    render_polygon result = {};
    result.vertex_count = 3;
 
-   result.vertices[0] = mesh->vertices[face.vertex_indices[0]];
-   result.vertices[1] = mesh->vertices[face.vertex_indices[1]];
-   result.vertices[2] = mesh->vertices[face.vertex_indices[2]];
+   for(int corner_index = 0; corner_index < 3; ++corner_index)
+   {
+      int vertex_index = face.vertex_indices[corner_index];
+      result.vertices[corner_index] = positions[vertex_index];
+      result.texcoords[corner_index] = get_vertex_texcoord(mesh, vertex_offset + vertex_index);
+   }
+
+   // NOTE: Meshes are flat shaded, so every corner carries the face normal.
+   result.normal = get_vertex_normal(mesh, vertex_offset + face.vertex_indices[0]);
 
-   result.texcoords[0] = mesh->texcoords[face.texcoord_indices[0]];
-   result.texcoords[1] = mesh->texcoords[face.texcoord_indices[1]];
-   result.texcoords[2] = mesh->texcoords[face.texcoord_indices[2]];
+   return(result);
+}
+
+static vec3 project_to_screen(mat4 projection, vec3 vertex, game_texture backbuffer)
+{
+   // NOTE: Project into clip coordinates.
+   vec3 result = project(projection, vertex);
 
-   assert(face.normal_indices[0] == face.normal_indices[1] &&
-          face.normal_indices[0] == face.normal_indices[2]);
+   // NOTE: Convert to screen coordinates.
+   result.x *= (backbuffer.width / 2.0f);
+   result.y *= -(backbuffer.height / 2.0f);
 
-   result.normal = mesh->normals[face.normal_indices[0]];
+   result.x += (backbuffer.width / 2.0f);
+   result.y += (backbuffer.height / 2.0f);
 
    return(result);
 }
@@ -4,10 +4,39 @@
 /* (c) copyright 2024 Lawrence D. Kern /////////////////////////////////////// */
 /* /////////////////////////////////////////////////////////////////////////// */
 
+// NOTE: Each combination of these features gets its own rasterizer loop,
+// specialized at compile time, so no per-pixel work branches on pipeline state.
+// A triangle's pipeline state is the bitmask of the features it needs.
+#define RENDER_PIPELINE_FEATURES                \
+   X(textured)                                  \
+   X(bilinear)                                  \
+   X(modulated)
+
+enum render_pipeline_feature
+{
+#  define X(feature_name) RENDERPIPELINE_BIT_##feature_name,
+   RENDER_PIPELINE_FEATURES
+#  undef X
+
+   RENDERPIPELINE_FEATURE_COUNT,
+};
+
+#define RENDERPIPELINE(feature_name) (1u << RENDERPIPELINE_BIT_##feature_name)
+#define RENDERPIPELINE_COUNT (1 << RENDERPIPELINE_FEATURE_COUNT)
+
 enum render_command_kind
 {
    RENDERCOMMAND_CLEAR,
-   RENDERCOMMAND_TRIANGLE,
+   RENDERCOMMAND_TRIANGLES,
+   RENDERCOMMAND_SPRITE,
+};
+
+// NOTE: A run of consecutive triangles that share a pipeline state.
+struct render_triangle_batch
+{
+   int triangle_index;
+   int triangle_count;
+   u32 pipeline;
 };
 
 struct render_command
@@ -17,14 +46,49 @@ struct render_command
    {
       u32 color;
       int index;
+      render_triangle_batch batch;
    };
 };
 
+// NOTE: Textured triangles sample the mip level whose texels best match the
+// pixel footprint of each 2x2 quad, using one of these filters.
+enum texture_filter
+{
+   TEXTUREFILTER_NEAREST,
+   TEXTUREFILTER_BILINEAR,
+};
+
 struct render_triangle
 {
    vec3 vertices[3];
    vec2 texcoords[3];
    u32 color;
+
+   // NOTE: Untextured triangles leave the texture null. Textured triangles also
+   // carry the reciprocal of each vertex's camera depth, for perspective-correct
+   // interpolation, and modulate their texels by the color.
+   mesh_asset_texture *texture;
+   float inverse_depths[3];
+   texture_filter filter;
+};
+
+// NOTE: Impostors are pre-rendered views of each mesh, baked at startup into
+// square cells of an atlas. Views are quantized by yaw around the mesh's z axis
+// and by pitch looking down from the horizon.
+#define IMPOSTOR_SIZE 32
+#define IMPOSTOR_YAW_COUNT 16
+#define IMPOSTOR_PITCH_COUNT 3
+#define IMPOSTOR_PITCH_STEP (1.0f / 24.0f)
+#define IMPOSTOR_VIEW_COUNT (IMPOSTOR_YAW_COUNT * IMPOSTOR_PITCH_COUNT)
+
+struct render_sprite
+{
+   int cell_index;
+
+   // NOTE: Screen-space top-left corner and edge length of the blitted quad.
+   int x;
+   int y;
+   int size;
 };
 
 struct render_polygon
@@ -3,54 +3,454 @@
 /* /////////////////////////////////////////////////////////////////////////// */
 
 #include "server.h"
+#include "network.cpp"
 
-SERVER_UPDATE(server_update)
+static u32 get_player_table_index(u64 client_id)
 {
-   server_packet result = {};
+   // NOTE: Fibonacci hashing, in case client IDs are ever less random than
+   // they are today.
+   u64 hash = client_id * 0x9E3779B97F4A7C15ull;
+   u32 result = (u32)(hash >> 32) & (SERVERPLAYER_TABLE_SIZE - 1);
 
-   // NOTE: Find the player that corresponds to the client who sent the packet.
-   server_player *player = 0;
-   for(int player_index = 0; player_index < SERVERPLAYER_COUNT_MAX; ++player_index)
+   return(result);
+}
+
+static int find_player_table_index(server_context *server, u64 client_id)
+{
+   int result = -1;
+
+   u32 index = get_player_table_index(client_id);
+   while(server->player_table[index])
    {
-      server_player *test = server->players + player_index;
-      if(test->client_id == packet->client_id)
+      server_player *test = server->players + (server->player_table[index] - 1);
+      if(test->client_id == client_id)
       {
-         player = test;
+         result = index;
          break;
       }
+
+      index = (index + 1) & (SERVERPLAYER_TABLE_SIZE - 1);
    }
 
-   // NOTE: If this player is not registered in the server yet, add them.
-   if(!player)
+   return(result);
+}
+
+static int find_player(server_context *server, u64 client_id)
+{
+   int result = -1;
+
+   int table_index = find_player_table_index(server, client_id);
+   if(table_index >= 0)
+   {
+      result = server->player_table[table_index] - 1;
+   }
+
+   return(result);
+}
+
+static int allocate_network_index(server_context *server)
+{
+   // NOTE: Hand out the lowest free index, which keeps snapshots short.
+   int result = -1;
+   for(int index = 0; index < SERVERPLAYER_COUNT_MAX; ++index)
+   {
+      u32 bit = (1u << (index % 32));
+      if(!(server->network_indices_used[index / 32] & bit))
+      {
+         server->network_indices_used[index / 32] |= bit;
+         result = index;
+         break;
+      }
+   }
+
+   assert(result >= 0 && result < SERVERPLAYER_COUNT_MAX);
+   return(result);
+}
+
+static void free_network_index(server_context *server, int index)
+{
+   server->network_indices_used[index / 32] &= ~(1u << (index % 32));
+}
+
+static int add_player(server_context *server, u64 client_id)
+{
+   int result = -1;
+   if(server->player_count < SERVERPLAYER_COUNT_MAX)
+   {
+      result = server->player_count++;
+
+      server->players[result] = {};
+      server->players[result].client_id = client_id;
+      server->clients[result] = {};
+      server->clients[result].network_index = allocate_network_index(server);
+
+      int network_index = server->clients[result].network_index;
+      server->network_indices_joined[network_index / 32] |= (1u << (network_index % 32));
+
+      u32 index = get_player_table_index(client_id);
+      while(server->player_table[index])
+      {
+         index = (index + 1) & (SERVERPLAYER_TABLE_SIZE - 1);
+      }
+      server->player_table[index] = (u16)(result + 1);
+   }
+
+   return(result);
+}
+
+static void remove_player(server_context *server, int slot)
+{
+   u32 mask = SERVERPLAYER_TABLE_SIZE - 1;
+
+   // NOTE: Empty the player's table entry, then shift back any later entries
+   // in the same probe run that could no longer be reached past the hole.
+   u32 hole = find_player_table_index(server, server->players[slot].client_id);
+   u32 next = (hole + 1) & mask;
+   while(server->player_table[next])
+   {
+      u64 next_client_id = server->players[server->player_table[next] - 1].client_id;
+      u32 home = get_player_table_index(next_client_id);
+      if(((next - home) & mask) >= ((next - hole) & mask))
+      {
+         server->player_table[hole] = server->player_table[next];
+         hole = next;
+      }
+      next = (next + 1) & mask;
+   }
+   server->player_table[hole] = 0;
+
+   free_network_index(server, server->clients[slot].network_index);
+
+   // NOTE: Fill the slot with the last player to keep the list dense.
+   int last = --server->player_count;
+   if(slot != last)
+   {
+      server->players[slot] = server->players[last];
+      server->clients[slot] = server->clients[last];
+      server->player_table[find_player_table_index(server, server->players[slot].client_id)] = (u16)(slot + 1);
+   }
+}
+
+static s32 get_grid_cell(float value)
+{
+   // NOTE: Round toward negative infinity, clamped well inside the range of an
+   // s32.
+   float scaled = value / SERVER_GRID_CELL_SIZE;
+   scaled = MINIMUM(MAXIMUM(scaled, -1000000.0f), 1000000.0f);
+
+   s32 result = (s32)scaled;
+   if((float)result > scaled)
+   {
+      result--;
+   }
+
+   return(result);
+}
+
+static u32 get_grid_bucket(s32 cell_x, s32 cell_y)
+{
+   u32 hash = ((u32)cell_x * 0x9E3779B1u) ^ ((u32)cell_y * 0x85EBCA77u);
+   hash ^= (hash >> 16);
+
+   u32 result = hash & (SERVER_GRID_BUCKET_COUNT - 1);
+   return(result);
+}
+
+static void build_grid(server_context *server)
+{
+   // NOTE: Counting sort of the player slots by bucket.
+   server_grid *grid = &server->grid;
+   for(int bucket = 0; bucket < countof(grid->bucket_starts); ++bucket)
+   {
+      grid->bucket_starts[bucket] = 0;
+   }
+
+   for(int slot = 0; slot < server->player_count; ++slot)
+   {
+      vec3 position = server->players[slot].position;
+      u32 bucket = get_grid_bucket(get_grid_cell(position.x), get_grid_cell(position.y));
+
+      grid->player_buckets[slot] = (u16)bucket;
+      grid->bucket_starts[bucket + 1]++;
+   }
+
+   u16 cursors[SERVER_GRID_BUCKET_COUNT];
+   for(int bucket = 0; bucket < SERVER_GRID_BUCKET_COUNT; ++bucket)
+   {
+      grid->bucket_starts[bucket + 1] += grid->bucket_starts[bucket];
+      cursors[bucket] = grid->bucket_starts[bucket];
+   }
+
+   for(int slot = 0; slot < server->player_count; ++slot)
+   {
+      grid->slots[cursors[grid->player_buckets[slot]]++] = (u16)slot;
+   }
+}
+
+static bool is_opponent_of_interest(server_player *player, server_player *opponent)
+{
+   float dx = opponent->position.x - player->position.x;
+   float dy = opponent->position.y - player->position.y;
+   float dz = opponent->position.z - player->position.z;
+   float distance_squared = dx*dx + dy*dy + dz*dz;
+
+   bool result = (distance_squared <= SERVER_INTEREST_NEAR_RADIUS*SERVER_INTEREST_NEAR_RADIUS);
+   if(!result && distance_squared <= SERVER_INTEREST_VIEW_RADIUS*SERVER_INTEREST_VIEW_RADIUS)
    {
-      assert(server->player_count < SERVERPLAYER_COUNT_MAX);
+      // NOTE: Compare cosines without normalizing either vector, which also
+      // copes with clients that send a view direction of any length.
+      vec3 view = player->view_direction;
+      float view_length_squared = view.x*view.x + view.y*view.y + view.z*view.z;
+      float along = dx*view.x + dy*view.y + dz*view.z;
 
-      player = server->players + server->player_count++;
-      player->client_id = packet->client_id;
+      float cosine_squared = SERVER_INTEREST_VIEW_COSINE*SERVER_INTEREST_VIEW_COSINE;
+      result = (along > 0.0f && along*along >= cosine_squared * distance_squared * view_length_squared);
+   }
+
+   return(result);
+}
+
+static void refresh_view_player(network_snapshot *view, network_snapshot *snapshot, int index)
+{
+   view->positions[index][0] = snapshot->positions[index][0];
+   view->positions[index][1] = snapshot->positions[index][1];
+   view->positions[index][2] = snapshot->positions[index][2];
+   view->sample_ages[index] = 0;
+}
+
+static network_snapshot *update_client_view(server_context *server, int slot)
+{
+   server_client *client = server->clients + slot;
+   server_player *player = server->players + slot;
+   network_snapshot *snapshot = &server->snapshot;
+
+   // NOTE: Start from last tick's view. Clients that just joined start empty.
+   u32 tick = snapshot->tick;
+   network_snapshot *previous = client->views + ((tick - 1) % NETWORK_SNAPSHOT_HISTORY);
+   network_snapshot *result = client->views + (tick % NETWORK_SNAPSHOT_HISTORY);
+   if(previous->tick == tick - 1)
+   {
+      *result = *previous;
+   }
+   else
+   {
+      *result = {};
+   }
+   result->tick = tick;
+   result->input_sequence = client->applied_input_sequence;
 
-      platform_log("Client %llu joined the server (player count = %d).\n", player->client_id, server->player_count);
+   // NOTE: Membership always follows the true state, so departures take
+   // effect at once and arrivals start out with their current position.
+   for(int word = 0; word < countof(result->present); ++word)
+   {
+      u32 present = snapshot->present[word];
+      u32 joined = present & (~result->present[word] | server->network_indices_joined[word]);
+      result->present[word] = present;
+
+      // NOTE: Every position carried over is a tick older, and absent players
+      // have no age. Refreshing a position resets its age.
+      u8 sample_age_max = (1 << NETWORK_SAMPLE_AGE_BITS) - 1;
+      for(int bit = 0; bit < 32; ++bit)
+      {
+         u8 *age = result->sample_ages + word*32 + bit;
+         if(!(present & (1u << bit)))
+         {
+            *age = 0;
+         }
+         else if(*age < sample_age_max)
+         {
+            (*age)++;
+         }
+      }
+
+      for(int bit = 0; joined; ++bit, joined >>= 1)
+      {
+         if(joined & 1)
+         {
+            refresh_view_player(result, snapshot, word*32 + bit);
+         }
+      }
    }
 
-   // NOTE: Update the player's position on the server.
-   player->position = packet->position;
+   // NOTE: The client reconciles its prediction against its own position, so
+   // that is always current.
+   refresh_view_player(result, snapshot, client->network_index);
 
-   platform_log("pos (%x): {%0.3f, %0.3f, %0.3f}\n",
-                player->client_id,
-                player->position.x,
-                player->position.y,
-                player->position.z);
+   // NOTE: Refresh the opponents of interest, visiting only the grid cells
+   // within reach of the view radius.
+   s32 min_x = get_grid_cell(player->position.x - SERVER_INTEREST_VIEW_RADIUS);
+   s32 max_x = get_grid_cell(player->position.x + SERVER_INTEREST_VIEW_RADIUS);
+   s32 min_y = get_grid_cell(player->position.y - SERVER_INTEREST_VIEW_RADIUS);
+   s32 max_y = get_grid_cell(player->position.y + SERVER_INTEREST_VIEW_RADIUS);
 
-   // NOTE: Send back information on all other player locations.
-   result.opponent_count = 0;
-   for(int player_index = 0; player_index < SERVERPLAYER_COUNT_MAX; ++player_index)
+   server_grid *grid = &server->grid;
+   for(s32 cell_y = min_y; cell_y <= max_y; ++cell_y)
    {
-      server_player *opponent = server->players + player_index;
-      if(opponent->client_id && opponent->client_id != player->client_id)
+      for(s32 cell_x = min_x; cell_x <= max_x; ++cell_x)
       {
-         result.opponents[player_index] = *opponent;
-         result.opponent_count++;
+         u32 bucket = get_grid_bucket(cell_x, cell_y);
+         for(int index = grid->bucket_starts[bucket]; index < grid->bucket_starts[bucket + 1]; ++index)
+         {
+            int opponent_slot = grid->slots[index];
+            if(opponent_slot != slot && is_opponent_of_interest(player, server->players + opponent_slot))
+            {
+               refresh_view_player(result, snapshot, server->clients[opponent_slot].network_index);
+            }
+         }
+      }
+   }
+
+   // NOTE: Refresh this tick's share of everyone else.
+   for(int index = tick % SERVER_INTEREST_DISTANT_INTERVAL; index < SERVERPLAYER_COUNT_MAX; index += SERVER_INTEREST_DISTANT_INTERVAL)
+   {
+      if(is_snapshot_player_present(result, index))
+      {
+         refresh_view_player(result, snapshot, index);
       }
    }
 
    return(result);
 }
+
+static float limit_axis_move(float from, float to, float limit)
+{
+   float result = MINIMUM(MAXIMUM(to, from - limit), from + limit);
+   return(result);
+}
+
+static vec3 limit_player_move(server_client *client, vec3 from, vec3 to, u64 tick)
+{
+   vec3 result = to;
+   if(client->has_applied_input)
+   {
+      float seconds = (float)(tick - client->applied_input_tick) / (float)SERVER_TICK_RATE;
+      float limit = SERVER_PLAYER_SPEED_MAX * seconds;
+
+      result.x = limit_axis_move(from.x, to.x, limit);
+      result.y = limit_axis_move(from.y, to.y, limit);
+      result.z = limit_axis_move(from.z, to.z, limit);
+   }
+
+   return(result);
+}
+
+SERVER_RECEIVE_PACKET(server_receive_packet)
+{
+   // NOTE: Find the player that corresponds to the client who sent the packet.
+   int slot = find_player(server, packet->client_id);
+
+   // NOTE: If this player is not registered in the server yet, add them.
+   if(slot < 0)
+   {
+      slot = add_player(server, packet->client_id);
+      if(slot < 0)
+      {
+         platform_log("WARNING: Client %llu was turned away from a full server.\n", packet->client_id);
+         return;
+      }
+
+      platform_log("Client %llu joined the server (player count = %d).\n", packet->client_id, server->player_count);
+   }
+
+   server_client *client = server->clients + slot;
+   client->address = address;
+   client->last_received_tick = server->tick;
+
+   // NOTE: Only the latest input before the tick is applied. Inputs that
+   // arrive after a newer one are stale.
+   if((s32)(packet->input_sequence - client->input.input_sequence) > 0)
+   {
+      client->has_input = true;
+      client->input = *packet;
+   }
+
+   // NOTE: Acks can arrive out of order, so only ever move forward.
+   if(packet->acked_tick > client->acked_tick && packet->acked_tick <= server->tick)
+   {
+      client->acked_tick = packet->acked_tick;
+   }
+}
+
+SERVER_TICK(server_tick)
+{
+   server->tick++;
+
+   // NOTE: Drop clients that have stopped sending. Removal moves the last
+   // player into the slot, so walk backwards.
+   for(int slot = server->player_count - 1; slot >= 0; --slot)
+   {
+      if(server->tick - server->clients[slot].last_received_tick > SERVER_CLIENT_TIMEOUT_TICKS)
+      {
+         platform_log("Client %llu timed out (player count = %d).\n", server->players[slot].client_id, server->player_count - 1);
+         remove_player(server, slot);
+      }
+   }
+
+   // NOTE: Apply the inputs received since the last tick.
+   for(int slot = 0; slot < server->player_count; ++slot)
+   {
+      server_client *client = server->clients + slot;
+      if(client->has_input)
+      {
+         server_player *player = server->players + slot;
+         player->position = limit_player_move(client, player->position, client->input.position, server->tick);
+         player->view_direction = client->input.view_direction;
+         client->has_input = false;
+
+         client->has_applied_input = true;
+         client->applied_input_tick = server->tick;
+         client->applied_input_sequence = client->input.input_sequence;
+
+#if DEBUG
+         platform_log("pos (%x): {%0.3f, %0.3f, %0.3f}\n",
+                      player->client_id,
+                      player->position.x,
+                      player->position.y,
+                      player->position.z);
+#endif
+      }
+   }
+
+   // NOTE: Record every player's true state, then bucket them for the
+   // interest queries.
+   network_snapshot *snapshot = &server->snapshot;
+   *snapshot = {};
+   snapshot->tick = (u32)server->tick;
+   for(int slot = 0; slot < server->player_count; ++slot)
+   {
+      set_snapshot_player(snapshot, server->clients[slot].network_index, server->players[slot].position);
+   }
+
+   build_grid(server);
+
+   // NOTE: Bring each client's view up to date and encode it against the
+   // newest view they have acknowledged, if that is still in the history.
+   for(int slot = 0; slot < server->player_count; ++slot)
+   {
+      server_client *client = server->clients + slot;
+      network_snapshot *view = update_client_view(server, slot);
+
+      network_snapshot *baseline = 0;
+      u32 baseline_age = view->tick - client->acked_tick;
+      if(client->acked_tick && baseline_age > 0 && baseline_age < NETWORK_SNAPSHOT_HISTORY)
+      {
+         // NOTE: An ack left over from before the client rejoined has no view
+         // behind it.
+         network_snapshot *acked_view = client->views + (client->acked_tick % NETWORK_SNAPSHOT_HISTORY);
+         if(acked_view->tick == client->acked_tick)
+         {
+            baseline = acked_view;
+         }
+      }
+
+      int snapshot_size = write_snapshot(server->snapshot_data, sizeof(server->snapshot_data), view, baseline, client->network_index);
+      assert(snapshot_size > 0);
+
+      client->datagram_count = write_fragments(client->datagrams, server->snapshot_data, snapshot_size, view->tick);
+   }
+
+   for(int word = 0; word < countof(server->network_indices_joined); ++word)
+   {
+      server->network_indices_joined[word] = 0;
+   }
+}
@@ -5,11 +5,117 @@
 #include "game.h"
 #include "platform.h"
 
+// NOTE: Players are stored densely in join order. An open-addressing table with
+// linear probing maps each client ID to its player slot, so finding the sender
+// of a packet costs the same however many players are connected. Table entries
+// hold the slot plus one, leaving zero for empty entries. Keeping the table at
+// most half full bounds the probe lengths.
+#define SERVERPLAYER_TABLE_SIZE (2 * SERVERPLAYER_COUNT_MAX)
+static_assert((SERVERPLAYER_TABLE_SIZE & (SERVERPLAYER_TABLE_SIZE - 1)) == 0, "Player table size must be a power of two.");
+
+// NOTE: The server runs at a fixed tick. Packets received between ticks only
+// record each client's latest input. Every tick applies those inputs, updates
+// each client's view of the other players, and encodes that view against the
+// last one the client acknowledged. The platform then sends each client its
+// encoded snapshot. Clients that go quiet for SERVER_CLIENT_TIMEOUT_TICKS are
+// dropped.
+#define SERVER_CLIENT_TIMEOUT_TICKS (5 * SERVER_TICK_RATE)
+
+// NOTE: The server has the final say on positions. A client's reported
+// position is accepted as long as no axis moved faster than this many units per
+// second since its last applied input, and is clamped otherwise. The first
+// input from a client places it anywhere.
+#define SERVER_PLAYER_SPEED_MAX 64.0f
+
+// NOTE: Interest management. A client's view always knows which players are
+// connected, but only refreshes the positions of opponents that matter to it.
+// Opponents within the near radius, or within the view radius and in front of
+// the client's camera, are refreshed every tick. Everyone else is refreshed
+// once every SERVER_INTEREST_DISTANT_INTERVAL ticks, staggered by network
+// index so the work is spread evenly across ticks.
+#define SERVER_INTEREST_NEAR_RADIUS 32.0f
+#define SERVER_INTEREST_VIEW_RADIUS 96.0f
+#define SERVER_INTEREST_VIEW_COSINE 0.5f
+#define SERVER_INTEREST_DISTANT_INTERVAL 8
+static_assert(SERVER_INTEREST_DISTANT_INTERVAL <= (1 << NETWORK_SAMPLE_AGE_BITS), "Sample ages can't span the distant interval.");
+
+// NOTE: Players are bucketed each tick into a uniform grid over the ground
+// plane, so finding the opponents near a client only visits the cells around
+// it. Cells are hashed into a fixed number of buckets, which keeps the grid
+// unbounded. Cells that share a bucket are told apart by the distance test.
+#define SERVER_GRID_CELL_SIZE 32.0f
+#define SERVER_GRID_BUCKET_COUNT (2 * SERVERPLAYER_COUNT_MAX)
+static_assert((SERVER_GRID_BUCKET_COUNT & (SERVER_GRID_BUCKET_COUNT - 1)) == 0, "Grid bucket count must be a power of two.");
+
+struct server_grid
+{
+   // NOTE: The players in bucket b are slots[bucket_starts[b]] up to
+   // slots[bucket_starts[b + 1]].
+   u16 bucket_starts[SERVER_GRID_BUCKET_COUNT + 1];
+   u16 slots[SERVERPLAYER_COUNT_MAX];
+   u16 player_buckets[SERVERPLAYER_COUNT_MAX];
+};
+
+// NOTE: An IPv4 address and port in network byte order, however the platform
+// received them.
+struct server_address
+{
+   u32 host;
+   u16 port;
+};
+
+struct server_client
+{
+   server_address address;
+   u64 last_received_tick;
+
+   int network_index;
+   u32 acked_tick;
+
+   // NOTE: What this client has been told about the other players, indexed by
+   // tick modulo NETWORK_SNAPSHOT_HISTORY.
+   network_snapshot views[NETWORK_SNAPSHOT_HISTORY];
+
+   bool has_input;
+   game_packet input;
+
+   bool has_applied_input;
+   u64 applied_input_tick;
+   u32 applied_input_sequence;
+
+   // NOTE: This tick's snapshot, split into datagrams for the platform to
+   // send.
+   int datagram_count;
+   network_datagram datagrams[NETWORK_FRAGMENT_COUNT_MAX];
+};
+
 struct server_context
 {
+   u64 tick;
+
+   // NOTE: clients[index] holds the connection state of players[index].
    int player_count;
    server_player players[SERVERPLAYER_COUNT_MAX];
+   server_client clients[SERVERPLAYER_COUNT_MAX];
+
+   u16 player_table[SERVERPLAYER_TABLE_SIZE];
+   u32 network_indices_used[(SERVERPLAYER_COUNT_MAX + 31) / 32];
+
+   // NOTE: The network indices handed out since the last tick. An index can be
+   // freed and handed to a new player between two ticks, so views can't spot
+   // every arrival from the present bits alone.
+   u32 network_indices_joined[(SERVERPLAYER_COUNT_MAX + 31) / 32];
+
+   // NOTE: Every player's true state as of the current tick.
+   network_snapshot snapshot;
+   server_grid grid;
+
+   // NOTE: Scratch space for encoding each client's snapshot.
+   u8 snapshot_data[NETWORK_SNAPSHOT_SIZE_MAX];
 };
 
-#define SERVER_UPDATE(name) server_packet name(server_context *server, game_packet *packet)
-SERVER_UPDATE(server_update);
+#define SERVER_RECEIVE_PACKET(name) void name(server_context *server, game_packet *packet, server_address address)
+SERVER_RECEIVE_PACKET(server_receive_packet);
+
+#define SERVER_TICK(name) void name(server_context *server)
+SERVER_TICK(server_tick);
@@ -38,6 +38,46 @@ typedef ptrdiff_t memsize;
 #   define assert JANK_ASSERT
 #endif
 
+// NOTE: Minimal atomics for handing results between the main thread and
+// worker threads. Loads acquire and stores release.
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#   define ATOMIC_LOAD(pointer) (u32)_InterlockedOr((volatile long *)(pointer), 0)
+#   define ATOMIC_STORE(pointer, value) _InterlockedExchange((volatile long *)(pointer), (long)(value))
+#   define ATOMIC_DECREMENT(pointer) (u32)_InterlockedDecrement((volatile long *)(pointer))
+#else
+#   define ATOMIC_LOAD(pointer) __atomic_load_n((pointer), __ATOMIC_ACQUIRE)
+#   define ATOMIC_STORE(pointer, value) __atomic_store_n((pointer), (value), __ATOMIC_RELEASE)
+#   define ATOMIC_DECREMENT(pointer) __atomic_sub_fetch((pointer), 1, __ATOMIC_ACQ_REL)
+#endif
+
+// NOTE: Requests for the platform's asynchronous file reads, see platform.h.
+// These live here since both the game and the platform layer hold them.
+struct platform_file
+{
+   s64 handle;
+   u64 size;
+};
+
+enum platform_read_status
+{
+   PLATFORMREAD_PENDING,
+   PLATFORMREAD_COMPLETE,
+   PLATFORMREAD_FAILED,
+};
+
+struct platform_read
+{
+   platform_file file;
+   u64 offset;
+   u64 size;
+   void *dest;
+
+   // NOTE: Owned by the platform until the status leaves pending.
+   volatile u32 status;
+   u64 transferred;
+};
+
 #define NETWORKING_SUPPORTED 0
 #define SERVER_HOST "localhost"
 #define SERVER_PORT 2000